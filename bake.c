@@ -0,0 +1,25 @@
+// Offline asset baker, run by `./nob` for every JSON under assets/.
+// Usage: bake <input.json> <output>
+// Loads the Overpass JSON once and writes the binary cache the app maps at startup
+// (see LoadOsmGeometryCached), so the app itself never has to parse it.
+#define NOB_IMPLEMENTATION
+#include "nob.h"
+
+#include "osm.h"
+
+int main(int argc, char **argv)
+{
+    const char *program = nob_shift(argv, argc);
+    if (argc != 2) {
+        nob_log(NOB_ERROR, "usage: %s <input.json> <output>", program);
+        return 1;
+    }
+    const char *input_path = argv[0];
+    const char *output_path = argv[1];
+
+    OsmGeometry geometry = {0};
+    if (!LoadOsmGeometry(input_path, &geometry)) return 1;
+    bool ok = SaveOsmGeometryCache(&geometry, output_path, input_path);
+    UnloadOsmGeometry(&geometry);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+// Offline tile baker, run by `./nob` for every PNG under assets/maps/.
+// Usage: baketiles <input.png> <output directory>
+// Cuts the image into the quadtree pyramid read by tiles.c: level z splits the image into
+// 2^z x 2^z tiles of TILE_SIZE pixels, down to the level that reaches the image resolution.
+#define NOB_IMPLEMENTATION
+#include "nob.h"
+
+#include "raylib.h"
+#include "tiles.h"
+
+int main(int argc, char **argv)
+{
+    const char *program = nob_shift(argv, argc);
+    if (argc != 2) {
+        nob_log(NOB_ERROR, "usage: %s <input.png> <output directory>", program);
+        return 1;
+    }
+    const char *input_path = argv[0];
+    const char *output_dir = argv[1];
+
+    SetTraceLogLevel(LOG_WARNING);
+    Image image = LoadImage(input_path);
+    if (!IsImageValid(image)) return 1;
+
+    int levels = 1;
+    while (levels < TILE_MAX_LEVELS &&
+           (image.width >> (levels - 1) > TILE_SIZE || image.height >> (levels - 1) > TILE_SIZE)) {
+        levels++;
+    }
+
+    bool result = true;
+    if (!nob_mkdir_if_not_exists(output_dir)) nob_return_defer(false);
+    for (int level = 0; level < levels; level++) {
+        if (!nob_mkdir_if_not_exists(nob_temp_sprintf("%s/%d", output_dir, level))) nob_return_defer(false);
+
+        int tiles = 1 << level;
+        for (int y = 0; y < tiles; y++) {
+            for (int x = 0; x < tiles; x++) {
+                size_t checkpoint = nob_temp_save();
+                // Tiles cover equal fractions of the image, whatever its aspect ratio
+                Rectangle source = {
+                    (float)x * image.width / tiles,
+                    (float)y * image.height / tiles,
+                    (float)image.width / tiles,
+                    (float)image.height / tiles,
+                };
+                Image tile = ImageFromImage(image, source);
+                ImageResize(&tile, TILE_SIZE, TILE_SIZE);
+                bool ok = ExportImage(tile, nob_temp_sprintf(TILE_PATH_FORMAT, output_dir, level, x, y));
+                UnloadImage(tile);
+                nob_temp_rewind(checkpoint);
+                if (!ok) nob_return_defer(false);
+            }
+        }
+    }
+
+    // Written last: nob only considers the pyramid baked once its index exists
+    const char *index = nob_temp_sprintf("%d\n", levels);
+    if (!nob_write_entire_file(nob_temp_sprintf("%s/%s", output_dir, TILE_INDEX_NAME), index, strlen(index))) {
+        nob_return_defer(false);
+    }
+
+defer:
+    UnloadImage(image);
+    return result ? 0 : 1;
+}
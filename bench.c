@@ -0,0 +1,601 @@
+// Micro-benchmarks for the loading code paths. Build and run with `./nob bench`.
+#include <stdio.h>
+#include <stdint.h>
+#include <locale.h>
+#include <math.h>
+#include <time.h>
+
+#define NOB_IMPLEMENTATION
+#include "nob.h"
+
+#include "cJSON/cJSON.h"
+#include "jobs.h"
+#include "osm.h"
+#include "world.h"
+
+#define BENCH_CONTOUR_PATH "bench_contour.json"
+#define ASSET_CONTOUR_PATH "assets/buildings/contour.json"
+#define BENCH_ITERATIONS 200
+
+static double BenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Writes an Overpass-like response with `node_count` nodes and one way referencing all of them
+// in a shuffled order, so lookups do not benefit from the nodes being sorted by id.
+static bool WriteSyntheticContour(const char *path, size_t node_count) {
+    Nob_String_Builder sb = {0};
+    nob_sb_append_cstr(&sb, "{\"version\":0.6,\"elements\":[\n");
+    for (size_t i = 0; i < node_count; i++) {
+        char line[128];
+        int n = snprintf(line, sizeof(line),
+                         "{\"type\":\"node\",\"id\":%zu,\"lat\":%.7f,\"lon\":%.7f},\n",
+                         1000000 + i, 48.868 + 1e-8 * i, 2.768 + 1e-8 * i);
+        nob_sb_append_buf(&sb, line, (size_t)n);
+    }
+    nob_sb_append_cstr(&sb, "{\"type\":\"way\",\"id\":1,\"nodes\":[");
+    uint32_t state = 0x9e3779b9;
+    for (size_t i = 0; i < node_count; i++) {
+        state = state * 1664525u + 1013904223u;
+        char id[32];
+        int n = snprintf(id, sizeof(id), "%s%zu", i == 0 ? "" : ",", 1000000 + state % node_count);
+        nob_sb_append_buf(&sb, id, (size_t)n);
+    }
+    nob_sb_append_cstr(&sb, "]}\n]}");
+    nob_sb_append_null(&sb);
+
+    bool result = nob_write_entire_file(path, sb.items, sb.count);
+    nob_sb_free(sb);
+    return result;
+}
+
+static void BenchLoadOsmGeometry(void) {
+    printf("LoadOsmGeometry (nodes, ms, ns/node):\n");
+    for (size_t node_count = 1000; node_count <= 1000000; node_count *= 10) {
+        if (!WriteSyntheticContour(BENCH_CONTOUR_PATH, node_count)) return;
+
+        OsmGeometry geometry = {0};
+        double start = BenchNow();
+        bool ok = LoadOsmGeometry(BENCH_CONTOUR_PATH, &geometry);
+        double elapsed = BenchNow() - start;
+        if (!ok || geometry.vertex_count != node_count) {
+            nob_log(NOB_ERROR, "LoadOsmGeometry produced %zu of %zu vertices", geometry.vertex_count, node_count);
+        }
+        printf("  %8zu %10.2f %8.1f\n", node_count, elapsed * 1e3, elapsed * 1e9 / node_count);
+        UnloadOsmGeometry(&geometry);
+    }
+    remove(BENCH_CONTOUR_PATH);
+}
+
+// Writes `node_count` nodes, a tagged way for every `BENCH_WAY_NODES` of them and a relation for every
+// `BENCH_RELATION_WAYS` ways, spread over the file
+#define BENCH_WAY_NODES 10
+#define BENCH_RELATION_WAYS 100
+static bool WriteSyntheticWays(const char *path, size_t node_count) {
+    Nob_String_Builder sb = {0};
+    nob_sb_append_cstr(&sb, "{\"version\":0.6,\"elements\":[\n");
+    uint32_t state = 0x9e3779b9;
+    for (size_t i = 0; i < node_count; i++) {
+        char line[192];
+        int n = snprintf(line, sizeof(line),
+                         "{\"type\":\"node\",\"id\":%zu,\"lat\":%.7f,\"lon\":%.7f},\n",
+                         1000000 + i, 48.868 + 1e-8 * i, 2.768 + 1e-8 * i);
+        nob_sb_append_buf(&sb, line, (size_t)n);
+        if ((i + 1) % BENCH_WAY_NODES != 0) continue;
+
+        n = snprintf(line, sizeof(line), "{\"type\":\"way\",\"id\":%zu,\"tags\":{\"highway\":\"residential\"},\"nodes\":[", i);
+        nob_sb_append_buf(&sb, line, (size_t)n);
+        for (size_t j = 0; j < BENCH_WAY_NODES; j++) {
+            state = state * 1664525u + 1013904223u;
+            n = snprintf(line, sizeof(line), "%s%zu", j == 0 ? "" : ",", 1000000 + state % node_count);
+            nob_sb_append_buf(&sb, line, (size_t)n);
+        }
+        nob_sb_append_cstr(&sb, "]},\n");
+        if ((i + 1) % (BENCH_RELATION_WAYS * BENCH_WAY_NODES) != 0) continue;
+
+        // A multipolygon of the last ways, with a member that is not a way and gets dropped
+        n = snprintf(line, sizeof(line), "{\"type\":\"relation\",\"id\":%zu,\"tags\":{\"type\":\"multipolygon\",\"building\":\"yes\"},"
+                     "\"members\":[{\"type\":\"node\",\"ref\":%zu,\"role\":\"\"}", i, 1000000 + i);
+        nob_sb_append_buf(&sb, line, (size_t)n);
+        for (size_t j = 0; j < 3; j++) {
+            n = snprintf(line, sizeof(line), ",{\"type\":\"way\",\"ref\":%zu,\"role\":\"%s\"}",
+                         i - j * BENCH_WAY_NODES, j == 0 ? "outer" : "inner");
+            nob_sb_append_buf(&sb, line, (size_t)n);
+        }
+        nob_sb_append_cstr(&sb, "]},\n");
+    }
+    nob_sb_append_cstr(&sb, "{\"type\":\"way\",\"id\":0,\"nodes\":[]}\n]}");
+
+    bool result = nob_write_entire_file(path, sb.items, sb.count);
+    nob_sb_free(sb);
+    return result;
+}
+
+// Every array of both geometries, the ones the loader fills at least
+static bool BenchSameGeometry(const OsmGeometry *a, const OsmGeometry *b) {
+#define BENCH_SAME(array, length) \
+    (a->length == b->length && (a->length == 0 || memcmp(a->array, b->array, a->length * sizeof(*a->array)) == 0))
+    return BENCH_SAME(vertices, vertex_count) && BENCH_SAME(world_vertices, vertex_count) &&
+           BENCH_SAME(vertex_importance, vertex_count) &&
+           BENCH_SAME(way_ids, way_count) && BENCH_SAME(way_offsets, way_count) && BENCH_SAME(way_counts, way_count) &&
+           BENCH_SAME(way_kinds, way_count) && BENCH_SAME(way_tag_offsets, way_count) && BENCH_SAME(way_tag_counts, way_count) &&
+           BENCH_SAME(relation_ids, relation_count) && BENCH_SAME(relation_member_offsets, relation_count) &&
+           BENCH_SAME(relation_member_counts, relation_count) && BENCH_SAME(relation_kinds, relation_count) &&
+           BENCH_SAME(relation_tag_offsets, relation_count) && BENCH_SAME(relation_tag_counts, relation_count) &&
+           BENCH_SAME(member_ways, member_count) && BENCH_SAME(member_roles, member_count) &&
+           BENCH_SAME(tag_keys, tag_count) && BENCH_SAME(tag_values, tag_count) &&
+           BENCH_SAME(strings, strings_size);
+#undef BENCH_SAME
+}
+
+// The elements array parsed on one thread vs. split across 2, 4, ... threads. ParallelFor starts them whatever the
+// number of cores, so the split path runs and is checked against the sequential one even on a single core.
+static void BenchParallelLoad(void) {
+    const size_t node_count = 1000000;
+    if (!WriteSyntheticWays(BENCH_CONTOUR_PATH, node_count)) return;
+
+    OsmGeometry sequential = {0};
+    double start = BenchNow();
+    bool ok = LoadOsmGeometryThreaded(BENCH_CONTOUR_PATH, &sequential, 1);
+    double sequential_time = BenchNow() - start;
+    const size_t cores = (size_t)nob_nprocs();
+    printf("LoadOsmGeometry of %zu nodes, %zu ways and %zu relations on %zu core%s (ms):\n",
+           node_count, sequential.way_count, sequential.relation_count, cores, cores == 1 ? "" : "s");
+    printf("  %2d thread  %10.2f\n", 1, sequential_time * 1e3);
+
+    const size_t max_threads = cores > 4 ? cores : 4;
+    for (size_t thread_count = 2; ok && thread_count <= max_threads; thread_count *= 2) {
+        OsmGeometry parallel = {0};
+        start = BenchNow();
+        bool parallel_ok = LoadOsmGeometryThreaded(BENCH_CONTOUR_PATH, &parallel, thread_count);
+        double parallel_time = BenchNow() - start;
+        bool same = parallel_ok && BenchSameGeometry(&sequential, &parallel);
+        printf("  %2zu threads %10.2f (%s)\n", thread_count, parallel_time * 1e3, same ? "same geometry" : "DIFFERENT geometry");
+        UnloadOsmGeometry(&parallel);
+    }
+    UnloadOsmGeometry(&sequential);
+    remove(BENCH_CONTOUR_PATH);
+}
+
+// Parse + free of a whole cJSON tree, with per-item malloc/free vs. an arena reset
+static void BenchArenaParse(void) {
+    Nob_String_View json_file = {0};
+    if (!nob_map_file(ASSET_CONTOUR_PATH, &json_file)) return;
+
+    double start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        cJSON *json = cJSON_ParseWithLength(json_file.data, json_file.count);
+        cJSON_Delete(json);
+    }
+    double heap = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    cJSON_Arena *arena = cJSON_CreateArena(0);
+    start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        cJSON_ParseWithLengthArena(json_file.data, json_file.count, arena);
+        cJSON_ResetArena(arena);
+    }
+    double arena_time = (BenchNow() - start) / BENCH_ITERATIONS;
+    cJSON_DeleteArena(arena);
+
+    printf("cJSON parse+free of %s (us):\n", ASSET_CONTOUR_PATH);
+    printf("  heap  %10.1f\n", heap * 1e6);
+    printf("  arena %10.1f\n", arena_time * 1e6);
+    nob_unmap_file(json_file);
+}
+
+typedef struct {
+    Nob_String_View *items;
+    size_t count;
+    size_t capacity;
+} BenchNumbers;
+
+// The number parsing cJSON did before its fast paths: copy into a stack buffer with the
+// decimal point of the current locale, then strtod
+static double BenchStrtodNumber(Nob_String_View number) {
+    char buffer[64];
+    char decimal_point = localeconv()->decimal_point[0];
+    size_t i = 0;
+    for (; i < number.count && i < sizeof(buffer) - 1; i++) {
+        buffer[i] = number.data[i] == '.' ? decimal_point : number.data[i];
+    }
+    buffer[i] = '\0';
+    return strtod(buffer, NULL);
+}
+
+static void BenchNumberParse(void) {
+    Nob_String_View json_file = {0};
+    BenchNumbers numbers = {0};
+    if (!nob_map_file(ASSET_CONTOUR_PATH, &json_file)) return;
+
+    // Every number token of the file, outside of strings
+    bool in_string = false;
+    for (size_t i = 0; i < json_file.count; i++) {
+        char c = json_file.data[i];
+        if (in_string) {
+            if (c == '\\') i++;
+            else if (c == '"') in_string = false;
+        }
+        else if (c == '"') {
+            in_string = true;
+        }
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            size_t start = i;
+            while (i < json_file.count && strchr("0123456789+-.eE", json_file.data[i]) != NULL) i++;
+            nob_da_append(&numbers, nob_sv_from_parts(json_file.data + start, i - start));
+        }
+    }
+
+    size_t mismatches = 0;
+    double sum = 0.0;
+    double start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        for (size_t i = 0; i < numbers.count; i++) sum += BenchStrtodNumber(numbers.items[i]);
+    }
+    double strtod_time = (BenchNow() - start) / (BENCH_ITERATIONS * numbers.count);
+
+    cJSON_Arena *arena = cJSON_CreateArena(0);
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        for (size_t i = 0; i < numbers.count; i++) {
+            cJSON *number = cJSON_ParseWithLengthArena(numbers.items[i].data, numbers.items[i].count, arena);
+            sum += number->valuedouble;
+        }
+        cJSON_ResetArena(arena);
+    }
+    double cjson_time = (BenchNow() - start) / (BENCH_ITERATIONS * numbers.count);
+
+    for (size_t i = 0; i < numbers.count; i++) {
+        cJSON *number = cJSON_ParseWithLengthArena(numbers.items[i].data, numbers.items[i].count, arena);
+        double expected = BenchStrtodNumber(numbers.items[i]);
+        if (number == NULL || memcmp(&number->valuedouble, &expected, sizeof(expected)) != 0) mismatches++;
+    }
+    cJSON_DeleteArena(arena);
+
+    printf("Number parsing of the %zu numbers in %s (ns/number):\n", numbers.count, ASSET_CONTOUR_PATH);
+    printf("  strtod %8.1f\n", strtod_time * 1e9);
+    printf("  cJSON  %8.1f (%zu mismatches, checksum %g)\n", cjson_time * 1e9, mismatches, sum);
+    nob_da_free(numbers);
+    nob_unmap_file(json_file);
+}
+
+// Reading type/id/lat/lon from every element: one scan per key vs. one scan for all keys
+static void BenchObjectLookup(void) {
+    static const char *const names[] = { "type", "id", "lat", "lon" };
+    Nob_String_View json_file = {0};
+    if (!nob_map_file(ASSET_CONTOUR_PATH, &json_file)) return;
+    cJSON *json = cJSON_ParseWithLength(json_file.data, json_file.count);
+    cJSON *elements = cJSON_GetObjectItemCaseSensitive(json, "elements");
+    cJSON *element = NULL;
+    size_t found = 0;
+
+    double start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        cJSON_ArrayForEach(element, elements) {
+            for (size_t i = 0; i < NOB_ARRAY_LEN(names); i++) {
+                found += cJSON_GetObjectItemCaseSensitive(element, names[i]) != NULL;
+            }
+        }
+    }
+    double single = BenchNow() - start;
+
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        cJSON_ArrayForEach(element, elements) {
+            cJSON *items[NOB_ARRAY_LEN(names)];
+            found += (size_t)cJSON_GetObjectItemsCaseSensitive(element, names, items, NOB_ARRAY_LEN(names));
+        }
+    }
+    double multi = BenchNow() - start;
+
+    printf("Element key lookups in %s (us per pass, %zu found):\n", ASSET_CONTOUR_PATH, found);
+    printf("  one key at a time %8.1f\n", single * 1e6 / BENCH_ITERATIONS);
+    printf("  all keys at once  %8.1f\n", multi * 1e6 / BENCH_ITERATIONS);
+    cJSON_Delete(json);
+    nob_unmap_file(json_file);
+}
+
+// Looking every member of a large object up by name: a scan of the members per lookup vs. the hashed index.
+// Every tenth member repeats the name of the one before, which both must resolve to the first of the two.
+static void BenchIndexedLookup(void) {
+    const size_t member_count = 4096;
+    cJSON *object = cJSON_CreateObject();
+    char (*names)[32] = NOB_REALLOC(NULL, (member_count + 1) * sizeof(*names));
+    NOB_ASSERT(object != NULL && names != NULL && "Buy more RAM lol");
+    for (size_t i = 0; i < member_count; i++) {
+        snprintf(names[i], sizeof(*names), "member%zu", i % 10 == 9 ? i - 1 : i);
+        cJSON_AddNumberToObject(object, names[i], (double)i);
+    }
+    // And one name that is not there
+    snprintf(names[member_count], sizeof(*names), "member%zu", member_count);
+
+    double start = BenchNow();
+    cJSON_ObjectIndex *index = cJSON_CreateObjectIndex(object);
+    double build = BenchNow() - start;
+    NOB_ASSERT(index != NULL && "Buy more RAM lol");
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i <= member_count; i++) {
+        mismatches += cJSON_GetIndexedItem(index, names[i]) != cJSON_GetObjectItemCaseSensitive(object, names[i]);
+    }
+
+    // The scans are quadratic in the member count, so fewer passes of them
+    size_t found = 0;
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS / 20; n++) {
+        for (size_t i = 0; i <= member_count; i++) found += cJSON_GetObjectItemCaseSensitive(object, names[i]) != NULL;
+    }
+    double scan = (BenchNow() - start) / (BENCH_ITERATIONS / 20);
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        for (size_t i = 0; i <= member_count; i++) found += cJSON_GetIndexedItem(index, names[i]) != NULL;
+    }
+    double indexed = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    printf("Looking up the %zu members of an object (ns per lookup, %zu found, %zu mismatches):\n",
+           member_count, found, mismatches);
+    printf("  scan    %10.1f\n", scan * 1e9 / (member_count + 1));
+    printf("  indexed %10.1f (built in %.1f us)\n", indexed * 1e9 / (member_count + 1), build * 1e6);
+    cJSON_DeleteObjectIndex(index);
+    NOB_FREE(names);
+    cJSON_Delete(object);
+}
+
+static size_t bench_allocated;
+static size_t bench_allocations;
+
+static void *BenchCountingMalloc(size_t size) {
+    bench_allocated += size;
+    bench_allocations++;
+    return malloc(size);
+}
+
+// The cJSON tree vs. the tape: memory, parse+free, and reading type/id/lat/lon from every element
+static void BenchTape(void) {
+    static const char *const names[] = { "type", "id", "lat", "lon" };
+    Nob_String_View json_file = {0};
+    if (!nob_map_file(ASSET_CONTOUR_PATH, &json_file)) return;
+
+    // Requested bytes only, malloc's own overhead per allocation comes on top for the tree
+    cJSON_Hooks counting_hooks = { BenchCountingMalloc, free };
+    cJSON_InitHooks(&counting_hooks);
+    bench_allocated = bench_allocations = 0;
+    cJSON *json = cJSON_ParseWithLength(json_file.data, json_file.count);
+    size_t tree_memory = bench_allocated;
+    size_t tree_allocations = bench_allocations;
+    bench_allocated = bench_allocations = 0;
+    cJSON_Tape *tape = cJSON_ParseTape(json_file.data, json_file.count);
+    size_t tape_allocations = bench_allocations;
+    cJSON_InitHooks(NULL);
+
+    double start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) cJSON_Delete(cJSON_ParseWithLength(json_file.data, json_file.count));
+    double tree_parse = (BenchNow() - start) / BENCH_ITERATIONS;
+    start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) cJSON_DeleteTape(cJSON_ParseTape(json_file.data, json_file.count));
+    double tape_parse = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    double tree_sum = 0.0;
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        cJSON *element = NULL;
+        cJSON_ArrayForEach(element, cJSON_GetObjectItemCaseSensitive(json, "elements")) {
+            cJSON *items[NOB_ARRAY_LEN(names)];
+            cJSON_GetObjectItemsCaseSensitive(element, names, items, NOB_ARRAY_LEN(names));
+            if (items[2] != NULL) tree_sum += items[2]->valuedouble;
+        }
+    }
+    double tree_lookup = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    double tape_sum = 0.0;
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+        const cJSON_TapeItem *element = NULL;
+        cJSON_TapeArrayForEach(element, cJSON_TapeGetObjectItemCaseSensitive(tape, cJSON_TapeRoot(tape), "elements")) {
+            const cJSON_TapeItem *items[NOB_ARRAY_LEN(names)];
+            cJSON_TapeGetObjectItemsCaseSensitive(tape, element, names, items, NOB_ARRAY_LEN(names));
+            if (items[2] != NULL) tape_sum += cJSON_TapeGetNumberValue(items[2]);
+        }
+    }
+    double tape_lookup = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    printf("cJSON tree vs. tape of %s:\n", ASSET_CONTOUR_PATH);
+    printf("  memory (KiB)     %10.1f %10.1f\n", tree_memory / 1024.0, cJSON_TapeMemory(tape) / 1024.0);
+    printf("  allocations      %10zu %10zu\n", tree_allocations, tape_allocations);
+    printf("  parse+free (us)  %10.1f %10.1f\n", tree_parse * 1e6, tape_parse * 1e6);
+    printf("  lookups (us)     %10.1f %10.1f (%s sums)\n", tree_lookup * 1e6, tape_lookup * 1e6,
+           tree_sum == tape_sum ? "same" : "different");
+    cJSON_DeleteTape(tape);
+    cJSON_Delete(json);
+    nob_unmap_file(json_file);
+}
+
+typedef enum {
+    BENCH_STRINGS_COPIED,
+    BENCH_STRINGS_COPIED_ARENA,
+    BENCH_STRINGS_INTERNED,
+    BENCH_STRINGS_IN_SITU,
+    BENCH_STRINGS_IN_SITU_ARENA,
+    BENCH_STRINGS_COUNT,
+} BenchStrings;
+
+static cJSON *BenchParseStrings(BenchStrings mode, char *buffer, size_t size, cJSON_KeyTable *keys, cJSON_Arena *arena) {
+    switch (mode) {
+    case BENCH_STRINGS_COPIED: return cJSON_ParseWithLength(buffer, size);
+    case BENCH_STRINGS_COPIED_ARENA: return cJSON_ParseWithLengthArena(buffer, size, arena);
+    case BENCH_STRINGS_INTERNED: return cJSON_ParseWithLengthInterned(buffer, size, keys, NULL);
+    case BENCH_STRINGS_IN_SITU: return cJSON_ParseInSitu(buffer, size, NULL);
+    case BENCH_STRINGS_IN_SITU_ARENA: return cJSON_ParseInSitu(buffer, size, arena);
+    default: NOB_UNREACHABLE("BenchStrings");
+    }
+}
+
+// Every string copied into an allocation of its own vs. names interned vs. strings unescaped in place.
+// The arena rows, and in situ which gets an arena of its own, bump-allocate the items too, which is
+// where most of the allocations are.
+// In-situ parsing consumes its input, so every variant parses a fresh copy of the file.
+static void BenchInSituStrings(void) {
+    static const char *const labels[BENCH_STRINGS_COUNT] = {
+        "copied", "copied+arena", "interned", "in situ", "in situ+arena",
+    };
+    Nob_String_View json_file = {0};
+    if (!nob_map_file(ASSET_CONTOUR_PATH, &json_file)) return;
+    char *buffer = NOB_REALLOC(NULL, json_file.count);
+    NOB_ASSERT(buffer != NULL && "Buy more RAM lol");
+
+    printf("cJSON strings of %s:      allocations  parse+free (us)\n", ASSET_CONTOUR_PATH);
+    for (BenchStrings mode = 0; mode < BENCH_STRINGS_COUNT; mode++) {
+        // The first parse counts everything, the key table and the arena included. They then live
+        // across parses, as they would when loading several files.
+        cJSON_Hooks counting_hooks = { BenchCountingMalloc, free };
+        cJSON_InitHooks(&counting_hooks);
+        bench_allocations = 0;
+        cJSON_KeyTable *keys = mode == BENCH_STRINGS_INTERNED ? cJSON_CreateKeyTable() : NULL;
+        bool uses_arena = mode == BENCH_STRINGS_COPIED_ARENA || mode == BENCH_STRINGS_IN_SITU_ARENA;
+        cJSON_Arena *arena = uses_arena ? cJSON_CreateArena(0) : NULL;
+        memcpy(buffer, json_file.data, json_file.count);
+        cJSON *json = BenchParseStrings(mode, buffer, json_file.count, keys, arena);
+        size_t allocations = bench_allocations;
+        if (!uses_arena) cJSON_Delete(json);
+        cJSON_InitHooks(NULL);
+        cJSON_ResetArena(arena);
+
+        double start = BenchNow();
+        for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+            memcpy(buffer, json_file.data, json_file.count);
+            json = BenchParseStrings(mode, buffer, json_file.count, keys, arena);
+            if (uses_arena) cJSON_ResetArena(arena);
+            else cJSON_Delete(json);
+        }
+        double elapsed = (BenchNow() - start) / BENCH_ITERATIONS;
+        printf("  %-14s %10zu %10.1f\n", labels[mode], allocations, elapsed * 1e6);
+
+        cJSON_DeleteArena(arena);
+        cJSON_DeleteKeyTable(keys);
+    }
+
+    NOB_FREE(buffer);
+    nob_unmap_file(json_file);
+}
+
+// The file as it is vs. minified: the whitespace the parsers step over a vector at a time
+static void BenchWhitespace(void) {
+    Nob_String_Builder pretty = {0};
+    if (!nob_read_entire_file(ASSET_CONTOUR_PATH, &pretty)) return;
+    Nob_String_Builder minified = {0};
+    nob_sb_append_buf(&minified, pretty.items, pretty.count);
+    nob_sb_append_null(&minified);
+    cJSON_Minify(minified.items);
+    Nob_String_View inputs[2] = { nob_sb_to_sv(pretty), nob_sv_from_cstr(minified.items) };
+    static const cJSON_StreamCallbacks no_callbacks = {0};
+
+    double times[2][2];
+    for (int i = 0; i < 2; i++) {
+        cJSON_Arena *arena = cJSON_CreateArena(0);
+        double start = BenchNow();
+        for (size_t j = 0; j < BENCH_ITERATIONS; j++) {
+            cJSON_ParseWithLengthArena(inputs[i].data, inputs[i].count, arena);
+            cJSON_ResetArena(arena);
+        }
+        times[i][0] = (BenchNow() - start) / BENCH_ITERATIONS;
+        cJSON_DeleteArena(arena);
+
+        start = BenchNow();
+        for (size_t j = 0; j < BENCH_ITERATIONS; j++) cJSON_ParseStream(inputs[i].data, inputs[i].count, &no_callbacks, NULL);
+        times[i][1] = (BenchNow() - start) / BENCH_ITERATIONS;
+    }
+
+    printf("Parsing %s as is (%zu bytes) vs. minified (%zu bytes) (us):\n", ASSET_CONTOUR_PATH, inputs[0].count, inputs[1].count);
+    printf("  tree   %10.1f %10.1f\n", times[0][0] * 1e6, times[1][0] * 1e6);
+    printf("  stream %10.1f %10.1f\n", times[0][1] * 1e6, times[1][1] * 1e6);
+    nob_sb_free(pretty);
+    nob_sb_free(minified);
+}
+
+// Parsing the JSON vs. mapping the baked cache of it
+static void BenchOsmCache(void) {
+    const char *cache_path = ASSET_CONTOUR_PATH ".bench" OSM_CACHE_EXTENSION;
+    OsmGeometry geometry = {0};
+    if (!LoadOsmGeometry(ASSET_CONTOUR_PATH, &geometry)) return;
+    if (!SaveOsmGeometryCache(&geometry, cache_path, ASSET_CONTOUR_PATH)) return;
+    UnloadOsmGeometry(&geometry);
+
+    double start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        LoadOsmGeometry(ASSET_CONTOUR_PATH, &geometry);
+        UnloadOsmGeometry(&geometry);
+    }
+    double json = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    size_t mapped = 0;
+    start = BenchNow();
+    for (size_t i = 0; i < BENCH_ITERATIONS; i++) {
+        mapped += MapOsmGeometryCache(cache_path, ASSET_CONTOUR_PATH, &geometry);
+        UnloadOsmGeometry(&geometry);
+    }
+    double cache = (BenchNow() - start) / BENCH_ITERATIONS;
+
+    printf("Loading %s (us):\n", ASSET_CONTOUR_PATH);
+    printf("  json   %10.1f\n", json * 1e6);
+    printf("  cache  %10.1f (%zu/%d mapped)\n", cache * 1e6, mapped, BENCH_ITERATIONS);
+    remove(cache_path);
+}
+
+// latlon_to_world one vertex at a time vs. the batch kernel, over points spread across the map
+static void BenchProjection(void) {
+    const size_t count = 1000000;
+    Vector2 *latlon = NOB_REALLOC(NULL, count * sizeof(*latlon));
+    Vector3 *scalar = NOB_REALLOC(NULL, count * sizeof(*scalar));
+    Vector3 *batch = NOB_REALLOC(NULL, count * sizeof(*batch));
+    NOB_ASSERT(latlon != NULL && scalar != NULL && batch != NULL);
+
+    uint32_t state = 0x9e3779b9;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        float t = (float)(state >> 8) / (float)(1u << 24);
+        latlon[i] = (Vector2){ MAP_LAT_MIN + t * MAP_LAT_HEIGHT, MAP_LON_MAX - t * MAP_LON_WIDTH };
+    }
+
+    double start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS / 10; n++) {
+        for (size_t i = 0; i < count; i++) scalar[i] = latlon_to_world(latlon[i], 0.0f);
+    }
+    double scalar_time = (BenchNow() - start) / (BENCH_ITERATIONS / 10);
+
+    start = BenchNow();
+    for (size_t n = 0; n < BENCH_ITERATIONS / 10; n++) {
+        ProjectLatLonToWorld(latlon, count, 0.0f, batch);
+    }
+    double batch_time = (BenchNow() - start) / (BENCH_ITERATIONS / 10);
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        max_error = fmaxf(max_error, fabsf(scalar[i].x - batch[i].x));
+        max_error = fmaxf(max_error, fabsf(scalar[i].y - batch[i].y));
+        max_error = fmaxf(max_error, fabsf(scalar[i].z - batch[i].z));
+    }
+
+    printf("Projection of %zu vertices to world space (ns/vertex):\n", count);
+    printf("  latlon_to_world      %6.2f\n", scalar_time * 1e9 / count);
+    printf("  ProjectLatLonToWorld %6.2f (max difference %g world units)\n", batch_time * 1e9 / count, max_error);
+    NOB_FREE(latlon);
+    NOB_FREE(scalar);
+    NOB_FREE(batch);
+}
+
+int main(void) {
+    BenchLoadOsmGeometry();
+    BenchParallelLoad();
+    BenchArenaParse();
+    BenchNumberParse();
+    BenchObjectLookup();
+    BenchIndexedLookup();
+    BenchWhitespace();
+    BenchTape();
+    BenchInSituStrings();
+    BenchOsmCache();
+    BenchProjection();
+    return 0;
+}
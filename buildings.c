@@ -0,0 +1,246 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "nob.h"
+#include "buildings.h"
+#include "world.h"
+
+#define BUILDINGS_FIELD_COUNT 9
+#define BUILDINGS_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define BUILDINGS_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define BUILDINGS_ALLOC_ARRAY(array, count)                               \
+    do {                                                                  \
+        (array) = NOB_REALLOC(NULL, ((count) + 1) * sizeof(*(array)));    \
+        NOB_ASSERT((array) != NULL && "Buy more RAM lol");                \
+    } while (0)
+
+// One parsed line, before the buildings are sorted and split into arrays
+typedef struct {
+    Nob_String_View name;
+    int year_from;
+    int year_to;
+    Vector2 latlon;
+    Vector2 size;
+    float height;
+    Color color;
+} BuildingRecord;
+
+typedef struct {
+    BuildingRecord *items;
+    size_t count;
+    size_t capacity;
+} BuildingRecords;
+
+static bool ParseBuildingNumber(Nob_String_View sv, double *number) {
+    // A local copy rather than nob_temp_sv_to_cstr, buildings may be loaded from a job thread
+    char cstr[64];
+    if (sv.count == 0 || sv.count >= sizeof(cstr)) return false;
+    memcpy(cstr, sv.data, sv.count);
+    cstr[sv.count] = '\0';
+    char *end = NULL;
+    *number = strtod(cstr, &end);
+    return *end == '\0';
+}
+
+static bool ParseBuildingColor(Nob_String_View sv, Color *color) {
+    if (sv.count != 6 && sv.count != 8) return false;
+    unsigned char channels[4] = { 0, 0, 0, 0xff };
+    for (size_t i = 0; i < sv.count; i++) {
+        char c = sv.data[i];
+        int digit = (c >= '0' && c <= '9') ? c - '0'
+                  : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                  : -1;
+        if (digit < 0) return false;
+        channels[i / 2] = (unsigned char)(i % 2 == 0 ? digit << 4 : channels[i / 2] | digit);
+    }
+    *color = (Color){ channels[0], channels[1], channels[2], channels[3] };
+    return true;
+}
+
+static bool ParseBuildingRecord(Nob_String_View line, BuildingRecord *record) {
+    Nob_String_View fields[BUILDINGS_FIELD_COUNT];
+    for (size_t i = 0; i < BUILDINGS_FIELD_COUNT; i++) {
+        if (line.count == 0) return false;
+        fields[i] = nob_sv_trim(nob_sv_chop_by_delim(&line, ','));
+    }
+    if (line.count > 0) return false;
+
+    double numbers[BUILDINGS_FIELD_COUNT - 2];
+    for (size_t i = 0; i < NOB_ARRAY_LEN(numbers); i++) {
+        if (!ParseBuildingNumber(fields[i + 1], &numbers[i])) return false;
+    }
+
+    record->name = fields[0];
+    record->year_from = (int)numbers[0];
+    record->year_to = (int)numbers[1];
+    record->latlon = (Vector2){ (float)numbers[2], (float)numbers[3] };
+    record->size = (Vector2){ (float)numbers[4], (float)numbers[5] };
+    record->height = (float)numbers[6];
+    if (record->year_to != -1 && record->year_to < record->year_from) return false;
+    return ParseBuildingColor(fields[8], &record->color);
+}
+
+static int CompareBuildingRecords(const void *a, const void *b) {
+    const BuildingRecord *ra = a;
+    const BuildingRecord *rb = b;
+    if (ra->year_from != rb->year_from) return ra->year_from < rb->year_from ? -1 : 1;
+    // Keep the order of the file for buildings of the same year
+    return ra->name.data < rb->name.data ? -1 : ra->name.data > rb->name.data;
+}
+
+// A building rises during [year_from - 1, year_from) and falls during [year_to, year_to + 1)
+static void BuildingVisibleYears(const Buildings *buildings, size_t i, int *first, int *last) {
+    *first = buildings->year_from[i] - 1;
+    *last = buildings->year_to[i] == -1 ? INT_MAX : buildings->year_to[i];
+}
+
+static void BuildBuildingsTimeline(Buildings *buildings) {
+    BuildingsTimeline *timeline = &buildings->timeline;
+    if (buildings->count == 0) return;
+
+    // From the first rise to the year after the last change, which only holds the buildings still standing
+    int first_year = INT_MAX;
+    int last_year = INT_MIN;
+    for (size_t i = 0; i < buildings->count; i++) {
+        first_year = BUILDINGS_MIN(first_year, buildings->year_from[i] - 1);
+        last_year = BUILDINGS_MAX(last_year, buildings->year_from[i]);
+        if (buildings->year_to[i] != -1) last_year = BUILDINGS_MAX(last_year, buildings->year_to[i] + 1);
+    }
+    timeline->first_year = first_year;
+    timeline->year_count = (size_t)(last_year - first_year) + 1;
+
+    size_t total = 0;
+    for (size_t i = 0; i < buildings->count; i++) {
+        int first, last;
+        BuildingVisibleYears(buildings, i, &first, &last);
+        total += (size_t)(BUILDINGS_MIN(last, last_year) - first) + 1;
+    }
+
+    BUILDINGS_ALLOC_ARRAY(timeline->offsets, timeline->year_count + 1);
+    BUILDINGS_ALLOC_ARRAY(timeline->buildings, total);
+    memset(timeline->offsets, 0, (timeline->year_count + 1) * sizeof(*timeline->offsets));
+
+    // Count per year, prefix sum, then fill: buildings are visited in order, so every bucket stays sorted
+    for (size_t i = 0; i < buildings->count; i++) {
+        int first, last;
+        BuildingVisibleYears(buildings, i, &first, &last);
+        for (int year = first; year <= BUILDINGS_MIN(last, last_year); year++) timeline->offsets[year - first_year + 1]++;
+    }
+    for (size_t y = 0; y < timeline->year_count; y++) timeline->offsets[y + 1] += timeline->offsets[y];
+    for (size_t i = 0; i < buildings->count; i++) {
+        int first, last;
+        BuildingVisibleYears(buildings, i, &first, &last);
+        for (int year = first; year <= BUILDINGS_MIN(last, last_year); year++) {
+            size_t *end = &timeline->offsets[year - first_year];
+            timeline->buildings[(*end)++] = i;
+        }
+    }
+    // The fill advanced every offset to the start of the next bucket
+    memmove(timeline->offsets + 1, timeline->offsets, timeline->year_count * sizeof(*timeline->offsets));
+    timeline->offsets[0] = 0;
+}
+
+const size_t *BuildingsAtYear(const Buildings *buildings, float year, size_t *count) {
+    const BuildingsTimeline *timeline = &buildings->timeline;
+    float bucket = floorf(year) - (float)timeline->first_year;
+    if (timeline->year_count == 0 || bucket < 0.0f) {
+        *count = 0;
+        return NULL;
+    }
+    // Past the last change every year looks the same
+    size_t y = BUILDINGS_MIN((size_t)bucket, timeline->year_count - 1);
+    *count = timeline->offsets[y + 1] - timeline->offsets[y];
+    return &timeline->buildings[timeline->offsets[y]];
+}
+
+bool BuildingStandsThroughYear(const Buildings *buildings, size_t i, int year) {
+    return buildings->year_from[i] <= year && (buildings->year_to[i] == -1 || buildings->year_to[i] > year);
+}
+
+BoundingBox BuildingBounds(const Buildings *buildings, size_t i, float z_offset) {
+    Vector3 position = buildings->world[i];
+    Vector3 half = { 0.5f * buildings->size[i].x * SCALE, 0.0f, 0.5f * buildings->size[i].y * SCALE };
+    return (BoundingBox){
+        { position.x - half.x, position.y + z_offset * SCALE, position.z - half.z },
+        { position.x + half.x, position.y + (z_offset + buildings->height[i]) * SCALE, position.z + half.z },
+    };
+}
+
+bool LoadBuildings(const char *filename, Buildings *buildings) {
+    bool result = true;
+    Nob_String_View file = {0};
+    BuildingRecords records = {0};
+    *buildings = (Buildings){0};
+
+    if (!nob_map_file(filename, &file)) nob_return_defer(false);
+    Nob_String_View content = file;
+
+    size_t strings_size = 0;
+    for (size_t line_number = 1; content.count > 0; line_number++) {
+        Nob_String_View line = nob_sv_trim(nob_sv_chop_by_delim(&content, '\n'));
+        if (line.count == 0 || line.data[0] == '#') continue;
+
+        BuildingRecord record = {0};
+        if (!ParseBuildingRecord(line, &record)) {
+            nob_log(NOB_ERROR, "%s:%zu: expected `name, year_from, year_to, lat, lon, width, length, height, rrggbb[aa]`",
+                    filename, line_number);
+            nob_return_defer(false);
+        }
+        nob_da_append(&records, record);
+        strings_size += record.name.count + 1;
+    }
+
+    qsort(records.items, records.count, sizeof(*records.items), CompareBuildingRecords);
+
+    buildings->count = records.count;
+    BUILDINGS_ALLOC_ARRAY(buildings->year_from, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->year_to, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->latlon, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->world, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->size, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->height, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->color, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->names, records.count);
+    BUILDINGS_ALLOC_ARRAY(buildings->strings, strings_size);
+
+    for (size_t i = 0; i < records.count; i++) {
+        const BuildingRecord *record = &records.items[i];
+        buildings->year_from[i] = record->year_from;
+        buildings->year_to[i] = record->year_to;
+        buildings->latlon[i] = record->latlon;
+        buildings->size[i] = record->size;
+        buildings->height[i] = record->height;
+        buildings->color[i] = record->color;
+        buildings->names[i] = buildings->strings_size;
+        memcpy(buildings->strings + buildings->strings_size, record->name.data, record->name.count);
+        buildings->strings_size += record->name.count;
+        buildings->strings[buildings->strings_size++] = '\0';
+    }
+
+    ProjectLatLonToWorld(buildings->latlon, buildings->count, 0.0f, buildings->world);
+    BuildBuildingsTimeline(buildings);
+
+defer:
+    if (!result) UnloadBuildings(buildings);
+    nob_da_free(records);
+    nob_unmap_file(file);
+    return result;
+}
+
+void UnloadBuildings(Buildings *buildings) {
+    NOB_FREE(buildings->year_from);
+    NOB_FREE(buildings->year_to);
+    NOB_FREE(buildings->latlon);
+    NOB_FREE(buildings->world);
+    NOB_FREE(buildings->size);
+    NOB_FREE(buildings->height);
+    NOB_FREE(buildings->color);
+    NOB_FREE(buildings->names);
+    NOB_FREE(buildings->strings);
+    NOB_FREE(buildings->timeline.offsets);
+    NOB_FREE(buildings->timeline.buildings);
+    *buildings = (Buildings){0};
+}
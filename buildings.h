@@ -0,0 +1,51 @@
+#ifndef BUILDINGS_H_
+#define BUILDINGS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+
+// Year-bucketed index of the buildings: bucket y holds, in ascending order, every building that is
+// standing or mid-transition at some point of [first_year + y, first_year + y + 1).
+typedef struct {
+    int first_year;
+    size_t year_count;
+    size_t *offsets;     // year_count + 1 offsets into buildings
+    size_t *buildings;
+} BuildingsTimeline;
+
+// Buildings of the timeline as a struct-of-arrays sorted by year_from.
+typedef struct {
+    int *year_from;
+    int *year_to;        // -1 while still standing
+    Vector2 *latlon;     // in degrees
+    Vector3 *world;      // latlon on the ground in world space, see ProjectLatLonToWorld
+    Vector2 *size;       // in meters
+    float *height;       // in meters
+    Color *color;
+    size_t *names;       // into strings
+    size_t count;
+
+    // NUL-terminated names packed back to back
+    char *strings;
+    size_t strings_size;
+
+    BuildingsTimeline timeline;
+} Buildings;
+
+// Loads a comma separated file with one building per line:
+//   name, year_from, year_to, lat, lon, width, length, height, rrggbb[aa]
+// Empty lines and lines starting with '#' are skipped.
+bool LoadBuildings(const char *filename, Buildings *buildings);
+void UnloadBuildings(Buildings *buildings);
+
+// Returns the indices of the buildings that may be visible at `year`: a superset of the
+// buildings standing, rising or falling then, at most one year's worth of changes larger.
+const size_t *BuildingsAtYear(const Buildings *buildings, float year, size_t *count);
+// True if building `i` stands still during all of [year, year + 1), neither rising nor falling.
+bool BuildingStandsThroughYear(const Buildings *buildings, size_t i, int year);
+// World space box of building `i`, `z_offset` meters above the ground.
+BoundingBox BuildingBounds(const Buildings *buildings, size_t i, float z_offset);
+
+#endif // BUILDINGS_H_
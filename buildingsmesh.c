@@ -0,0 +1,131 @@
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "buildingsmesh.h"
+#include "renderstats.h"
+#include "world.h"
+
+#define BOX_VERTEX_COUNT 36
+
+// Corner i of a box is at -/+ half extent along x, y, z for bits 0, 1, 2 of i.
+// Faces list their corners counter-clockwise seen from outside, as backface culling expects.
+static const int box_faces[6][4] = {
+    { 5, 1, 3, 7 }, // +x
+    { 0, 4, 6, 2 }, // -x
+    { 2, 6, 7, 3 }, // +y
+    { 0, 1, 5, 4 }, // -y
+    { 4, 5, 7, 6 }, // +z
+    { 1, 0, 2, 3 }, // -z
+};
+
+// Same box as DrawCube would draw for the building standing on the ground
+static void WriteBuildingBox(const Buildings *buildings, size_t i, float *vertices, unsigned char *colors) {
+    Vector3 center = buildings->world[i];
+    center.y += 0.5f * buildings->height[i] * SCALE;
+    Vector3 half = {
+        0.5f * buildings->size[i].x * SCALE,
+        0.5f * buildings->height[i] * SCALE,
+        0.5f * buildings->size[i].y * SCALE,
+    };
+    Color color = buildings->color[i];
+
+    size_t v = 0;
+    for (size_t face = 0; face < 6; face++) {
+        const int quad[6] = {
+            box_faces[face][0], box_faces[face][1], box_faces[face][2],
+            box_faces[face][0], box_faces[face][2], box_faces[face][3],
+        };
+        for (size_t k = 0; k < 6; k++, v++) {
+            int corner = quad[k];
+            vertices[3*v + 0] = center.x + ((corner & 1) ? half.x : -half.x);
+            vertices[3*v + 1] = center.y + ((corner & 2) ? half.y : -half.y);
+            vertices[3*v + 2] = center.z + ((corner & 4) ? half.z : -half.z);
+            colors[4*v + 0] = color.r;
+            colors[4*v + 1] = color.g;
+            colors[4*v + 2] = color.b;
+            colors[4*v + 3] = color.a;
+        }
+    }
+}
+
+BuildingsMesh LoadBuildingsMesh(const Buildings *buildings) {
+    BuildingsMesh buildings_mesh = { 0 };
+    buildings_mesh.year = INT_MIN;
+    buildings_mesh.material = LoadMaterialDefault();
+
+    for (size_t i = 0; i < buildings->count; i++) {
+        BuildingsMeshCell *cell = &buildings_mesh.cells[CullGridCell(buildings->world[i])];
+        BoundingBox bounds = BuildingBounds(buildings, i, 0.0f);
+        cell->bounds = cell->capacity == 0 ? bounds : BoundingBoxUnion(cell->bounds, bounds);
+        cell->capacity++;
+    }
+
+    // Allocated once for the worst case, every rebuild only rewrites the start of the buffers
+    for (size_t c = 0; c < CULL_GRID_CELLS; c++) {
+        BuildingsMeshCell *cell = &buildings_mesh.cells[c];
+        if (cell->capacity == 0) continue;
+        Mesh *mesh = &cell->mesh;
+        mesh->vertexCount = (int)(cell->capacity * BOX_VERTEX_COUNT);
+        mesh->triangleCount = mesh->vertexCount / 3;
+        mesh->vertices = MemAlloc(mesh->vertexCount * 3 * sizeof(float));
+        mesh->colors = MemAlloc(mesh->vertexCount * 4 * sizeof(unsigned char));
+        UploadMesh(mesh, true);
+        mesh->vertexCount = 0;
+        mesh->triangleCount = 0;
+    }
+    return buildings_mesh;
+}
+
+void UpdateBuildingsMesh(BuildingsMesh *buildings_mesh, const Buildings *buildings, float current_year) {
+    int year = (int)floorf(current_year);
+    if (year == buildings_mesh->year || buildings->count == 0) return;
+    buildings_mesh->year = year;
+
+    for (size_t c = 0; c < CULL_GRID_CELLS; c++) buildings_mesh->cells[c].building_count = 0;
+    buildings_mesh->building_count = 0;
+
+    size_t visible_count = 0;
+    const size_t *visible = BuildingsAtYear(buildings, current_year, &visible_count);
+    for (size_t v = 0; v < visible_count; v++) {
+        size_t i = visible[v];
+        if (!BuildingStandsThroughYear(buildings, i, year)) continue;
+        BuildingsMeshCell *cell = &buildings_mesh->cells[CullGridCell(buildings->world[i])];
+        WriteBuildingBox(buildings, i,
+                         &cell->mesh.vertices[cell->building_count * BOX_VERTEX_COUNT * 3],
+                         &cell->mesh.colors[cell->building_count * BOX_VERTEX_COUNT * 4]);
+        cell->building_count++;
+        buildings_mesh->building_count++;
+    }
+
+    for (size_t c = 0; c < CULL_GRID_CELLS; c++) {
+        BuildingsMeshCell *cell = &buildings_mesh->cells[c];
+        Mesh *mesh = &cell->mesh;
+        mesh->vertexCount = (int)(cell->building_count * BOX_VERTEX_COUNT);
+        mesh->triangleCount = mesh->vertexCount / 3;
+        if (cell->building_count == 0) continue;
+        UpdateMeshBuffer(*mesh, 0, mesh->vertices, mesh->vertexCount * 3 * sizeof(float), 0);
+        UpdateMeshBuffer(*mesh, 3, mesh->colors, mesh->vertexCount * 4 * sizeof(unsigned char), 0);
+    }
+}
+
+void DrawBuildingsMesh(const BuildingsMesh *buildings_mesh, const Frustum *frustum) {
+    for (size_t c = 0; c < CULL_GRID_CELLS; c++) {
+        const BuildingsMeshCell *cell = &buildings_mesh->cells[c];
+        if (cell->building_count == 0) continue;
+        if (!FrustumContainsBox(frustum, cell->bounds)) continue;
+        DrawMesh(cell->mesh, buildings_mesh->material, MatrixIdentity());
+        CountDraw(1, (size_t)cell->mesh.vertexCount);
+    }
+}
+
+void UnloadBuildingsMesh(BuildingsMesh *buildings_mesh) {
+    for (size_t c = 0; c < CULL_GRID_CELLS; c++) {
+        if (buildings_mesh->cells[c].mesh.vaoId != 0) UnloadMesh(buildings_mesh->cells[c].mesh);
+    }
+    // The default material only references the default shader and texture, which it must not unload
+    RL_FREE(buildings_mesh->material.maps);
+    *buildings_mesh = (BuildingsMesh){ 0 };
+}
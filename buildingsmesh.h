@@ -0,0 +1,31 @@
+#ifndef BUILDINGSMESH_H_
+#define BUILDINGSMESH_H_
+
+#include "raylib.h"
+#include "buildings.h"
+#include "culling.h"
+
+typedef struct {
+    Mesh mesh;                // buffers sized for all buildings of the cell, vertexCount is what is in use
+    BoundingBox bounds;       // of all buildings of the cell, whatever the year
+    size_t capacity;          // buildings of the cell
+    size_t building_count;    // buildings in the mesh
+} BuildingsMeshCell;
+
+// The boxes of every building that stands still during the current year, one GPU mesh per
+// culling grid cell so that only the cells in view are drawn. The meshes are rebuilt only when the
+// year changes; the few buildings rising or falling during that year are left out and drawn separately.
+typedef struct {
+    BuildingsMeshCell cells[CULL_GRID_CELLS];
+    Material material;
+    int year;                 // year the meshes were built for
+    size_t building_count;    // buildings in all meshes
+} BuildingsMesh;
+
+BuildingsMesh LoadBuildingsMesh(const Buildings *buildings);
+// Rebuilds the meshes if `current_year` is in another year than the one they were built for.
+void UpdateBuildingsMesh(BuildingsMesh *buildings_mesh, const Buildings *buildings, float current_year);
+void DrawBuildingsMesh(const BuildingsMesh *buildings_mesh, const Frustum *frustum);
+void UnloadBuildingsMesh(BuildingsMesh *buildings_mesh);
+
+#endif // BUILDINGSMESH_H_
@@ -49,6 +49,19 @@
 #include <locale.h>
 #endif
 
+/* Vector units for the whitespace and string scans, disabled with CJSON_DISABLE_SIMD.
+ * SSE2 is part of every x86-64 target, AVX2 is used when the compiler targets it (-mavx2). */
+#if !defined(CJSON_DISABLE_SIMD) && defined(__AVX2__)
+#define CJSON_AVX2 1
+#include <immintrin.h>
+#elif !defined(CJSON_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define CJSON_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -249,6 +262,265 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     return node;
 }
 
+/* Bump allocator that a whole parsed document can be allocated from. Blocks are chained
+ * and only ever released all at once. */
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+} arena_block;
+
+struct cJSON_Arena
+{
+    internal_hooks hooks;
+    arena_block *blocks;
+    size_t block_size;
+};
+
+/* keep allocations aligned for any member of cJSON */
+#define arena_align(size) (((size) + (sizeof(double) - 1)) & ~(sizeof(double) - 1))
+#define arena_block_data(block) ((unsigned char*)(block) + arena_align(sizeof(arena_block)))
+
+static void *arena_allocate(cJSON_Arena * const arena, size_t size)
+{
+    arena_block *block = arena->blocks;
+    void *memory = NULL;
+
+    size = arena_align(size);
+    if ((block == NULL) || ((block->size - block->used) < size))
+    {
+        size_t block_size = (size > arena->block_size) ? size : arena->block_size;
+        block = (arena_block*)arena->hooks.allocate(arena_align(sizeof(arena_block)) + block_size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->size = block_size;
+        block->used = 0;
+        /* oversized allocations get a block of their own behind the current one,
+         * so the remaining space of the current block is not wasted */
+        if ((arena->blocks != NULL) && (size > arena->block_size))
+        {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        }
+        else
+        {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+    }
+
+    memory = arena_block_data(block) + block->used;
+    block->used += size;
+    return memory;
+}
+
+CJSON_PUBLIC(cJSON_Arena *) cJSON_CreateArena(size_t block_size)
+{
+    cJSON_Arena *arena = (cJSON_Arena*)global_hooks.allocate(sizeof(cJSON_Arena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    arena->hooks = global_hooks;
+    arena->blocks = NULL;
+    arena->block_size = (block_size == 0) ? CJSON_ARENA_DEFAULT_BLOCK_SIZE : block_size;
+    return arena;
+}
+
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena)
+{
+    arena_block *block = NULL;
+
+    if ((arena == NULL) || (arena->blocks == NULL))
+    {
+        return;
+    }
+
+    /* keep the most recent block around for the next document */
+    block = arena->blocks->next;
+    while (block != NULL)
+    {
+        arena_block *next = block->next;
+        arena->hooks.deallocate(block);
+        block = next;
+    }
+    arena->blocks->next = NULL;
+    arena->blocks->used = 0;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteArena(cJSON_Arena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    cJSON_ResetArena(arena);
+    if (arena->blocks != NULL)
+    {
+        arena->hooks.deallocate(arena->blocks);
+    }
+    arena->hooks.deallocate(arena);
+}
+
+/* The root of a tree flagged cJSON_OwnsArena is allocated behind the pointer to its arena */
+typedef struct
+{
+    cJSON_Arena *arena;
+    cJSON item;
+} arena_root;
+
+#define arena_root_of(item) ((arena_root*)(void*)((unsigned char*)(item) - offsetof(arena_root, item)))
+
+/* Interning table for object member names: open addressing with linear probing, sized to at
+ * most half full. The names themselves are bump-allocated from an arena of the table. */
+typedef struct
+{
+    size_t hash;
+    size_t length;
+    const unsigned char *key;
+} key_table_slot;
+
+struct cJSON_KeyTable
+{
+    internal_hooks hooks;
+    cJSON_Arena *strings;
+    key_table_slot *slots;
+    size_t capacity; /* power of two */
+    size_t count;
+};
+
+#define KEY_TABLE_INITIAL_CAPACITY 64
+#define KEY_TABLE_BLOCK_SIZE 4096
+
+/* FNV-1a */
+static size_t hash_bytes(const unsigned char *bytes, size_t length)
+{
+    size_t hash = (size_t)2166136261u;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (size_t)bytes[i];
+        hash *= (size_t)16777619u;
+    }
+    return hash;
+}
+
+CJSON_PUBLIC(cJSON_KeyTable *) cJSON_CreateKeyTable(void)
+{
+    cJSON_KeyTable *table = (cJSON_KeyTable*)global_hooks.allocate(sizeof(cJSON_KeyTable));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+
+    table->hooks = global_hooks;
+    table->count = 0;
+    table->capacity = KEY_TABLE_INITIAL_CAPACITY;
+    table->strings = cJSON_CreateArena(KEY_TABLE_BLOCK_SIZE);
+    table->slots = (key_table_slot*)global_hooks.allocate(table->capacity * sizeof(key_table_slot));
+    if ((table->strings == NULL) || (table->slots == NULL))
+    {
+        cJSON_DeleteKeyTable(table);
+        return NULL;
+    }
+    memset(table->slots, '\0', table->capacity * sizeof(key_table_slot));
+
+    return table;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteKeyTable(cJSON_KeyTable *table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+
+    cJSON_DeleteArena(table->strings);
+    if (table->slots != NULL)
+    {
+        table->hooks.deallocate(table->slots);
+    }
+    table->hooks.deallocate(table);
+}
+
+static cJSON_bool key_table_grow(cJSON_KeyTable * const table)
+{
+    size_t capacity = table->capacity * 2;
+    key_table_slot *slots = NULL;
+    size_t i = 0;
+
+    if (capacity > ((size_t)-1) / sizeof(key_table_slot))
+    {
+        return false; /* overflow */
+    }
+    slots = (key_table_slot*)table->hooks.allocate(capacity * sizeof(key_table_slot));
+    if (slots == NULL)
+    {
+        return false; /* allocation failure */
+    }
+    memset(slots, '\0', capacity * sizeof(key_table_slot));
+
+    for (i = 0; i < table->capacity; i++)
+    {
+        size_t slot = 0;
+        if (table->slots[i].key == NULL)
+        {
+            continue;
+        }
+        for (slot = table->slots[i].hash & (capacity - 1); slots[slot].key != NULL; slot = (slot + 1) & (capacity - 1))
+        {
+        }
+        slots[slot] = table->slots[i];
+    }
+
+    table->hooks.deallocate(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return true;
+}
+
+/* The zero terminated copy of key owned by the table, made the first time key is seen. NULL on allocation failure. */
+static const unsigned char *key_table_intern(cJSON_KeyTable * const table, const unsigned char *key, size_t length)
+{
+    size_t hash = hash_bytes(key, length);
+    size_t slot = 0;
+    unsigned char *copy = NULL;
+
+    /* grown ahead of the lookup, so that probing always ends on an empty slot */
+    if ((2 * (table->count + 1) > table->capacity) && !key_table_grow(table))
+    {
+        return NULL;
+    }
+
+    for (slot = hash & (table->capacity - 1); table->slots[slot].key != NULL; slot = (slot + 1) & (table->capacity - 1))
+    {
+        if ((table->slots[slot].hash == hash) && (table->slots[slot].length == length) && (memcmp(table->slots[slot].key, key, length) == 0))
+        {
+            return table->slots[slot].key;
+        }
+    }
+
+    copy = (unsigned char*)arena_allocate(table->strings, length + sizeof(""));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, key, length);
+    copy[length] = '\0';
+
+    table->slots[slot].hash = hash;
+    table->slots[slot].length = length;
+    table->slots[slot].key = copy;
+    table->count++;
+
+    return copy;
+}
+
 /* Delete a cJSON structure. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
 {
@@ -256,6 +528,13 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
     while (item != NULL)
     {
         next = item->next;
+        if (item->type & cJSON_OwnsArena)
+        {
+            /* the whole tree is in the arena */
+            cJSON_DeleteArena(arena_root_of(item)->arena);
+            item = next;
+            continue;
+        }
         if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
             cJSON_Delete(item->child);
@@ -286,6 +565,63 @@ static unsigned char get_decimal_point(void)
 #endif
 }
 
+/* Vectorized scans: the parsers classify SCAN_WIDTH bytes at a time into whitespace, or into quotes and
+ * backslashes, to step over whitespace and through strings instead of walking them byte by byte.
+ * Only the bytes the parser walks are classified: in Overpass output most whitespace runs are a few
+ * bytes long, and classifying the whole input upfront into an index was measured slower than that.
+ * Without vector units, the byte by byte loops are the fallback. */
+#if defined(CJSON_AVX2)
+#define SCAN_WIDTH 32
+/* bit i set if byte i is whitespace (<= 32, as buffer_skip_whitespace skips) */
+static unsigned int scan_whitespace(const unsigned char *bytes)
+{
+    __m256i vector = _mm256_loadu_si256((const __m256i*)(const void*)bytes);
+    /* unsigned bytes <= 32 are those whose maximum with 32 is 32 */
+    return (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(vector, _mm256_set1_epi8(32)), _mm256_set1_epi8(32)));
+}
+/* bit i set if byte i is a quote or a backslash */
+static unsigned int scan_string_special(const unsigned char *bytes)
+{
+    __m256i vector = _mm256_loadu_si256((const __m256i*)(const void*)bytes);
+    return (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(vector, _mm256_set1_epi8('\"')), _mm256_cmpeq_epi8(vector, _mm256_set1_epi8('\\'))));
+}
+#elif defined(CJSON_SSE2)
+#define SCAN_WIDTH 16
+static unsigned int scan_whitespace(const unsigned char *bytes)
+{
+    __m128i vector = _mm_loadu_si128((const __m128i*)(const void*)bytes);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(vector, _mm_set1_epi8(32)), _mm_set1_epi8(32)));
+}
+static unsigned int scan_string_special(const unsigned char *bytes)
+{
+    __m128i vector = _mm_loadu_si128((const __m128i*)(const void*)bytes);
+    return (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(vector, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(vector, _mm_set1_epi8('\\'))));
+}
+#endif
+
+#ifdef SCAN_WIDTH
+#define SCAN_ALL ((unsigned int)(((unsigned long long)1 << SCAN_WIDTH) - 1))
+
+static unsigned int trailing_zeroes(unsigned int bits)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctz(bits);
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, bits);
+    return (unsigned int)index;
+#else
+    unsigned int count = 0;
+    while ((bits & 1) == 0)
+    {
+        bits >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+#endif
+
 typedef struct
 {
     const unsigned char *content;
@@ -293,8 +629,48 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    cJSON_Arena *arena; /* if not NULL, the parsed items and strings are allocated from it instead of hooks */
+    unsigned char *insitu; /* if not NULL, the mutable content: strings are unescaped in place instead of allocated */
+    cJSON_KeyTable *keys; /* if not NULL, object member names are interned in it instead of allocated */
 } parse_buffer;
 
+/* Allocation while parsing goes to the arena if there is one. Arena memory is never freed individually. */
+static void *parse_allocate(const parse_buffer * const buffer, size_t size)
+{
+    if (buffer->arena != NULL)
+    {
+        return arena_allocate(buffer->arena, size);
+    }
+    return buffer->hooks.allocate(size);
+}
+
+static void parse_deallocate(const parse_buffer * const buffer, void *pointer)
+{
+    if (buffer->arena == NULL)
+    {
+        buffer->hooks.deallocate(pointer);
+    }
+}
+
+static cJSON *parse_new_item(const parse_buffer * const buffer)
+{
+    cJSON *node = (cJSON*)parse_allocate(buffer, sizeof(cJSON));
+    if (node)
+    {
+        memset(node, '\0', sizeof(cJSON));
+    }
+
+    return node;
+}
+
+static void parse_delete(const parse_buffer * const buffer, cJSON *item)
+{
+    if (buffer->arena == NULL)
+    {
+        cJSON_Delete(item);
+    }
+}
+
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
 #define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
 /* check if the buffer can be accessed at the given index (starting with 0) */
@@ -303,114 +679,303 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+/* Fast path for integral numbers: accumulate the digits directly so values beyond 2^53
+ * (like OSM ids) are kept exactly. Returns false without consuming input if the number
+ * has a fraction or exponent or does not fit in 64 bits, in which case strtod takes over. */
+static cJSON_bool parse_integer(cJSON * const item, parse_buffer * const input_buffer)
 {
-    double number = 0;
-    unsigned char *after_end = NULL;
-    unsigned char number_c_string[64];
-    unsigned char decimal_point = get_decimal_point();
+    const unsigned char *number = buffer_at_offset(input_buffer);
+    size_t available = input_buffer->length - input_buffer->offset;
+    unsigned long long magnitude = 0;
+    cJSON_bool negative = false;
     size_t i = 0;
+    size_t digits_start = 0;
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if ((available > 0) && (number[0] == '-'))
     {
-        return false;
+        negative = true;
+        i++;
     }
+    digits_start = i;
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; (i < (sizeof(number_c_string) - 1)) && can_access_at_index(input_buffer, i); i++)
+    for (; (i < available) && (number[i] >= '0') && (number[i] <= '9'); i++)
     {
-        switch (buffer_at_offset(input_buffer)[i])
+        unsigned int digit = (unsigned int)(number[i] - '0');
+        if (magnitude > (ULLONG_MAX - digit) / 10)
         {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '+':
-            case '-':
-            case 'e':
-            case 'E':
-                number_c_string[i] = buffer_at_offset(input_buffer)[i];
-                break;
-
-            case '.':
-                number_c_string[i] = decimal_point;
-                break;
-
-            default:
-                goto loop_end;
+            return false; /* overflow */
         }
+        magnitude = magnitude * 10 + digit;
     }
-loop_end:
-    number_c_string[i] = '\0';
 
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
+    if (i == digits_start)
     {
-        return false; /* parse_error */
+        return false;
     }
-
-    item->valuedouble = number;
-
-    /* use saturation in case of overflow */
-    if (number >= LONG_MAX)
+    if ((i < available) && ((number[i] == '.') || (number[i] == 'e') || (number[i] == 'E')))
     {
-        item->valueint = LONG_MAX;
+        return false; /* not an integer */
     }
-    else if (number <= (double)LONG_MIN)
+
+    if (negative)
     {
-        item->valueint = LONG_MIN;
+        /* -0 is -0.0, which the decimal path keeps */
+        if ((magnitude == 0) || (magnitude > (unsigned long long)LLONG_MAX + 1))
+        {
+            return false;
+        }
+        item->valueint = (magnitude == (unsigned long long)LLONG_MAX + 1) ? LLONG_MIN : -(long long)magnitude;
     }
     else
     {
-        item->valueint = (int)number;
+        if (magnitude > (unsigned long long)LLONG_MAX)
+        {
+            return false;
+        }
+        item->valueint = (long long)magnitude;
     }
 
+    item->valuedouble = (double)item->valueint;
     item->type = cJSON_Number;
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
+    input_buffer->offset += i;
     return true;
 }
 
-/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
-CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+/* Clinger's fast path: a decimal with at most 19 significant digits whose value is m * 10^e with
+ * m <= 2^53 and |e| <= 22 is converted exactly by a single IEEE multiplication or division,
+ * because both m and 10^|e| are exactly representable. That covers coordinates such as the OSM
+ * lat/lon values, without copying the number, querying the locale or calling strtod.
+ * Returns false without consuming input for anything else, which then goes through strtod. */
+static cJSON_bool parse_decimal(cJSON * const item, parse_buffer * const input_buffer)
 {
-    if (number >= LONG_MAX)
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+    static const double powers_of_ten[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const unsigned char *number = buffer_at_offset(input_buffer);
+    size_t available = input_buffer->length - input_buffer->offset;
+    unsigned long long mantissa = 0;
+    size_t digit_count = 0;
+    long exponent = 0;
+    long explicit_exponent = 0;
+    cJSON_bool negative = false;
+    double value = 0;
+    size_t i = 0;
+    size_t start = 0;
+
+    if ((available > 0) && (number[0] == '-'))
     {
-        object->valueint = LONG_MAX;
+        negative = true;
+        i++;
     }
-    else if (number <= (double)LONG_MIN)
+
+    /* integer part, at least one digit */
+    for (start = i; (i < available) && (number[i] >= '0') && (number[i] <= '9'); i++)
     {
-        object->valueint = LONG_MIN;
+        if ((digit_count > 0) || (number[i] != '0'))
+        {
+            if (++digit_count > 19)
+            {
+                return false;
+            }
+        }
+        mantissa = mantissa * 10 + (unsigned long long)(number[i] - '0');
     }
-    else
+    if (i == start)
     {
-        object->valueint = (int)number;
+        return false;
     }
 
-    return object->valuedouble = number;
-}
-
-/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
-CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
-{
-    char *copy = NULL;
-    size_t v1_len;
-    size_t v2_len;
-    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
-    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    /* fraction, at least one digit */
+    if ((i < available) && (number[i] == '.'))
     {
-        return NULL;
-    }
-    /* return NULL if the object is corrupted or valuestring is NULL */
+        i++;
+        for (start = i; (i < available) && (number[i] >= '0') && (number[i] <= '9'); i++)
+        {
+            if ((digit_count > 0) || (number[i] != '0'))
+            {
+                if (++digit_count > 19)
+                {
+                    return false;
+                }
+            }
+            mantissa = mantissa * 10 + (unsigned long long)(number[i] - '0');
+            exponent--;
+        }
+        if (i == start)
+        {
+            return false;
+        }
+    }
+
+    /* exponent, at least one digit */
+    if ((i < available) && ((number[i] == 'e') || (number[i] == 'E')))
+    {
+        cJSON_bool negative_exponent = false;
+        i++;
+        if ((i < available) && ((number[i] == '+') || (number[i] == '-')))
+        {
+            negative_exponent = (number[i] == '-');
+            i++;
+        }
+        for (start = i; (i < available) && (number[i] >= '0') && (number[i] <= '9'); i++)
+        {
+            if (explicit_exponent > 1000)
+            {
+                return false;
+            }
+            explicit_exponent = explicit_exponent * 10 + (long)(number[i] - '0');
+        }
+        if (i == start)
+        {
+            return false;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if ((mantissa > (1ULL << 53)) || (exponent < -22) || (exponent > 22))
+    {
+        return false;
+    }
+
+    value = (double)mantissa;
+    if (exponent < 0)
+    {
+        value /= powers_of_ten[-exponent];
+    }
+    else
+    {
+        value *= powers_of_ten[exponent];
+    }
+
+    cJSON_SetNumberHelper(item, negative ? -value : value);
+    item->type = cJSON_Number;
+
+    input_buffer->offset += i;
+    return true;
+#else
+    /* excess precision (e.g. x87) would double round, leave it to strtod */
+    (void)item;
+    (void)input_buffer;
+    return false;
+#endif
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+{
+    double number = 0;
+    unsigned char *after_end = NULL;
+    unsigned char number_c_string[64];
+    unsigned char decimal_point = get_decimal_point();
+    size_t i = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false;
+    }
+
+    if (parse_integer(item, input_buffer) || parse_decimal(item, input_buffer))
+    {
+        return true;
+    }
+
+    /* copy the number into a temporary buffer and replace '.' with the decimal point
+     * of the current locale (for strtod)
+     * This also takes care of '\0' not necessarily being available for marking the end of the input */
+    for (i = 0; (i < (sizeof(number_c_string) - 1)) && can_access_at_index(input_buffer, i); i++)
+    {
+        switch (buffer_at_offset(input_buffer)[i])
+        {
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9':
+            case '+':
+            case '-':
+            case 'e':
+            case 'E':
+                number_c_string[i] = buffer_at_offset(input_buffer)[i];
+                break;
+
+            case '.':
+                number_c_string[i] = decimal_point;
+                break;
+
+            default:
+                goto loop_end;
+        }
+    }
+loop_end:
+    number_c_string[i] = '\0';
+
+    number = strtod((const char*)number_c_string, (char**)&after_end);
+    if (number_c_string == after_end)
+    {
+        return false; /* parse_error */
+    }
+
+    item->valuedouble = number;
+
+    /* use saturation in case of overflow */
+    if (number >= LLONG_MAX)
+    {
+        item->valueint = LLONG_MAX;
+    }
+    else if (number <= (double)LLONG_MIN)
+    {
+        item->valueint = LLONG_MIN;
+    }
+    else
+    {
+        item->valueint = (long long)number;
+    }
+
+    item->type = cJSON_Number;
+
+    input_buffer->offset += (size_t)(after_end - number_c_string);
+    return true;
+}
+
+/* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
+CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
+{
+    if (number >= LLONG_MAX)
+    {
+        object->valueint = LLONG_MAX;
+    }
+    else if (number <= (double)LLONG_MIN)
+    {
+        object->valueint = LLONG_MIN;
+    }
+    else
+    {
+        object->valueint = (long long)number;
+    }
+
+    return object->valuedouble = number;
+}
+
+/* Note: when passing a NULL valuestring, cJSON_SetValuestring treats this as an error and return NULL */
+CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
+{
+    char *copy = NULL;
+    size_t v1_len;
+    size_t v2_len;
+    /* if object's type is not cJSON_String or is cJSON_IsReference, it should not set valuestring */
+    if ((object == NULL) || !(object->type & cJSON_String) || (object->type & cJSON_IsReference))
+    {
+        return NULL;
+    }
+    /* return NULL if the object is corrupted or valuestring is NULL */
     if (object->valuestring == NULL || valuestring == NULL)
     {
         return NULL;
@@ -583,7 +1148,7 @@ static cJSON_bool print_number(const cJSON * const item, printbuffer * const out
     }
     else if(d == (double)item->valueint)
     {
-        length = sprintf((char*)number_buffer, "%ld", item->valueint);
+        length = sprintf((char*)number_buffer, "%lld", item->valueint);
     }
     else
     {
@@ -788,71 +1353,86 @@ fail:
     return 0;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+/* Find the closing quote of the string literal at the current offset.
+ * Returns NULL if the string is not terminated, otherwise a pointer to the closing quote.
+ * unescaped_length receives an upper bound of the unescaped string length. */
+static const unsigned char *find_string_end(const parse_buffer * const input_buffer, size_t * const unescaped_length)
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
     const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    size_t skipped_bytes = 0;
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+#ifdef SCAN_WIDTH
+    /* whole vectors while they fit, the loop below finishes the string */
+    while ((size_t)(input_end + SCAN_WIDTH - input_buffer->content) <= input_buffer->length)
     {
-        goto fail;
+        unsigned int special = scan_string_special(input_end);
+        if (special == 0)
+        {
+            input_end += SCAN_WIDTH;
+            continue;
+        }
+        input_end += trailing_zeroes(special);
+        if (*input_end == '\"')
+        {
+            break;
+        }
+        /* is escape sequence */
+        if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+        {
+            return NULL;
+        }
+        skipped_bytes++;
+        input_end += 2;
     }
+#endif
 
+    while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        /* is escape sequence */
+        if (input_end[0] == '\\')
         {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
+            if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
             {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
-                {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
+                /* prevent buffer overflow when last input character is a backslash */
+                return NULL;
             }
+            skipped_bytes++;
             input_end++;
         }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
-        {
-            goto fail; /* string ended unexpectedly */
-        }
-
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
-        {
-            goto fail; /* allocation failure */
-        }
+        input_end++;
     }
+    if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+    {
+        return NULL; /* string ended unexpectedly */
+    }
+
+    /* This is at most how much we need for the output */
+    *unescaped_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
+    return input_end;
+}
 
-    output_pointer = output;
+/* Unescape the string literal contents [*input_pointer, input_end) into output.
+ * Returns a pointer past the last written byte (not zero terminated), or NULL on failure,
+ * in which case *input_pointer points at the offending escape sequence. */
+static unsigned char *unescape_string(const unsigned char **input_pointer, const unsigned char * const input_end, unsigned char *output_pointer)
+{
     /* loop through the string literal */
-    while (input_pointer < input_end)
+    while (*input_pointer < input_end)
     {
-        if (*input_pointer != '\\')
+        if (**input_pointer != '\\')
         {
-            *output_pointer++ = *input_pointer++;
+            *output_pointer++ = *(*input_pointer)++;
         }
         /* escape sequence */
         else
         {
             unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
+            if ((input_end - *input_pointer) < 1)
             {
-                goto fail;
+                return NULL;
             }
 
-            switch (input_pointer[1])
+            switch ((*input_pointer)[1])
             {
                 case 'b':
                     *output_pointer++ = '\b';
@@ -872,31 +1452,87 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
                 case '\"':
                 case '\\':
                 case '/':
-                    *output_pointer++ = input_pointer[1];
+                    *output_pointer++ = (*input_pointer)[1];
                     break;
 
                 /* UTF-16 literal */
                 case 'u':
-                    sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
+                    sequence_length = utf16_literal_to_utf8(*input_pointer, input_end, &output_pointer);
                     if (sequence_length == 0)
                     {
                         /* failed to convert UTF16-literal to UTF-8 */
-                        goto fail;
+                        return NULL;
                     }
                     break;
 
                 default:
-                    goto fail;
+                    return NULL;
             }
-            input_pointer += sequence_length;
+            *input_pointer += sequence_length;
         }
     }
 
-    /* zero terminate the output */
-    *output_pointer = '\0';
+    return output_pointer;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+    size_t allocation_length = 0;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    input_end = find_string_end(input_buffer, &allocation_length);
+    if (input_end == NULL)
+    {
+        goto fail;
+    }
+
+    if (input_buffer->insitu != NULL)
+    {
+        /* unescaping never writes ahead of what it reads, and the terminator takes the closing quote */
+        output_pointer = input_buffer->insitu + (input_end - input_buffer->content);
+        if (allocation_length != (size_t)(input_end - input_pointer) + 1)
+        {
+            output_pointer = unescape_string(&input_pointer, input_end, input_buffer->insitu + (input_pointer - input_buffer->content));
+            if (output_pointer == NULL)
+            {
+                goto fail;
+            }
+        }
+        *output_pointer = '\0';
+
+        item->type = cJSON_String | cJSON_IsReference;
+        item->valuestring = (char*)input_buffer->insitu + (buffer_at_offset(input_buffer) + 1 - input_buffer->content);
+    }
+    else
+    {
+        output = (unsigned char*)parse_allocate(input_buffer, allocation_length + sizeof(""));
+        if (output == NULL)
+        {
+            goto fail; /* allocation failure */
+        }
+
+        output_pointer = unescape_string(&input_pointer, input_end, output);
+        if (output_pointer == NULL)
+        {
+            goto fail;
+        }
 
-    item->type = cJSON_String;
-    item->valuestring = (char*)output;
+        /* zero terminate the output */
+        *output_pointer = '\0';
+
+        item->type = cJSON_String;
+        item->valuestring = (char*)output;
+    }
 
     input_buffer->offset = (size_t) (input_end - input_buffer->content);
     input_buffer->offset++;
@@ -906,7 +1542,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 fail:
     if (output != NULL)
     {
-        input_buffer->hooks.deallocate(output);
+        parse_deallocate(input_buffer, output);
         output = NULL;
     }
 
@@ -1040,166 +1676,1400 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
     return true;
 }
 
-/* Invoke print_string_ptr (which is useful) on an item. */
-static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+/* Invoke print_string_ptr (which is useful) on an item. */
+static cJSON_bool print_string(const cJSON * const item, printbuffer * const p)
+{
+    return print_string_ptr((unsigned char*)item->valuestring, p);
+}
+
+/* Predeclare these prototypes. */
+static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
+static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+
+/* Parse the name of an object member into item->string. key_flags receives cJSON_StringIsConst when the
+ * name is not owned by the item: interned in the key table, or unescaped in situ. */
+static cJSON_bool parse_key(cJSON * const item, parse_buffer * const input_buffer, int * const key_flags)
+{
+    *key_flags = 0;
+
+    /* names with escape sequences are rare, they are unescaped and allocated as usual */
+    if ((input_buffer->keys != NULL) && can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+        size_t length = 0;
+        const unsigned char *input_end = find_string_end(input_buffer, &length);
+        if ((input_end != NULL) && (length == (size_t)(input_end - input_pointer) + 1))
+        {
+            const unsigned char *key = key_table_intern(input_buffer->keys, input_pointer, length - 1);
+            if (key == NULL)
+            {
+                return false; /* allocation failure */
+            }
+            item->string = (char*)key;
+            *key_flags = cJSON_StringIsConst;
+            input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+            return true;
+        }
+    }
+
+    if (!parse_string(item, input_buffer))
+    {
+        return false;
+    }
+
+    /* swap valuestring and string, because we parsed the name */
+    item->string = item->valuestring;
+    item->valuestring = NULL;
+    if (input_buffer->insitu != NULL)
+    {
+        *key_flags = cJSON_StringIsConst;
+    }
+    return true;
+}
+
+/* Utility to jump whitespace and cr/lf */
+static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL))
+    {
+        return NULL;
+    }
+
+    if (cannot_access_at_index(buffer, 0))
+    {
+        return buffer;
+    }
+
+#ifdef SCAN_WIDTH
+    while (can_access_at_index(buffer, SCAN_WIDTH - 1) && (buffer_at_offset(buffer)[0] <= 32))
+    {
+        unsigned int tokens = ~scan_whitespace(buffer_at_offset(buffer)) & SCAN_ALL;
+        if (tokens != 0)
+        {
+            buffer->offset += trailing_zeroes(tokens);
+            break;
+        }
+        buffer->offset += SCAN_WIDTH;
+    }
+#endif
+    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    {
+       buffer->offset++;
+    }
+
+    if (buffer->offset == buffer->length)
+    {
+        buffer->offset--;
+    }
+
+    return buffer;
+}
+
+/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
+static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+{
+    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    {
+        return NULL;
+    }
+
+    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+    {
+        buffer->offset += 3;
+    }
+
+    return buffer;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    size_t buffer_length;
+
+    if (NULL == value)
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    buffer_length = strlen(value) + sizeof("");
+
+    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+}
+
+/* Parse an object - create a new root, and populate. With owns_arena, the root is an arena_root
+ * of arena and the caller deletes the arena on failure. */
+static cJSON *parse_root(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, cJSON_Arena *arena, cJSON_bool owns_arena, unsigned char *insitu, cJSON_KeyTable *keys)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON *item = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (value == NULL || 0 == buffer_length)
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.arena = arena;
+    buffer.insitu = insitu;
+    buffer.keys = keys;
+
+    if (owns_arena)
+    {
+        arena_root *root = (arena_root*)arena_allocate(arena, sizeof(arena_root));
+        if (root != NULL)
+        {
+            memset(root, '\0', sizeof(arena_root));
+            root->arena = arena;
+            item = &root->item;
+        }
+    }
+    else
+    {
+        item = parse_new_item(&buffer);
+    }
+    if (item == NULL) /* memory fail */
+    {
+        goto fail;
+    }
+
+    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    {
+        /* parse failure. ep is set. */
+        goto fail;
+    }
+
+    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
+    if (require_null_terminated)
+    {
+        buffer_skip_whitespace(&buffer);
+        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+        {
+            goto fail;
+        }
+    }
+    if (return_parse_end)
+    {
+        *return_parse_end = (const char*)buffer_at_offset(&buffer);
+    }
+    if (owns_arena)
+    {
+        item->type |= cJSON_OwnsArena;
+    }
+
+    return item;
+
+fail:
+    if (item != NULL)
+    {
+        parse_delete(&buffer, item);
+    }
+
+    if (value != NULL)
+    {
+        error local_error;
+        local_error.json = (const unsigned char*)value;
+        local_error.position = 0;
+
+        if (buffer.offset < buffer.length)
+        {
+            local_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            local_error.position = buffer.length - 1;
+        }
+
+        if (return_parse_end != NULL)
+        {
+            *return_parse_end = (const char*)local_error.json + local_error.position;
+        }
+
+        global_error = local_error;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse_root(value, buffer_length, return_parse_end, require_null_terminated, NULL, false, NULL, NULL);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArena(const char *value, size_t buffer_length, cJSON_Arena *arena)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return parse_root(value, buffer_length, NULL, false, arena, false, NULL, NULL);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSitu(char *value, size_t buffer_length, cJSON_Arena *arena)
+{
+    cJSON *item = NULL;
+
+    if (arena != NULL)
+    {
+        return parse_root(value, buffer_length, NULL, false, arena, false, (unsigned char*)value, NULL);
+    }
+
+    /* the strings are in value already, so the items are the only allocations left: without an arena
+     * of the caller's, the tree gets one of its own rather than an allocation per item */
+    arena = cJSON_CreateArena(0);
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+    item = parse_root(value, buffer_length, NULL, false, arena, true, (unsigned char*)value, NULL);
+    if (item == NULL)
+    {
+        cJSON_DeleteArena(arena);
+    }
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthInterned(const char *value, size_t buffer_length, cJSON_KeyTable *keys, cJSON_Arena *arena)
+{
+    if (keys == NULL)
+    {
+        return NULL;
+    }
+
+    return parse_root(value, buffer_length, NULL, false, arena, false, NULL, keys);
+}
+
+/* Default options for cJSON_Parse */
+CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
+{
+    return cJSON_ParseWithOpts(value, 0, 0);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+}
+
+/* State of a streaming parse: the callbacks and a scratch buffer that unescaped strings are
+ * passed in, so that no allocation happens per value. */
+typedef struct
+{
+    const cJSON_StreamCallbacks *callbacks;
+    void *user_data;
+    unsigned char *scratch;
+    size_t scratch_size;
+} stream_context;
+
+static cJSON_bool stream_value(parse_buffer * const input_buffer, stream_context * const context);
+
+/* Unescape the string at the current offset into the scratch buffer. */
+static cJSON_bool stream_string(parse_buffer * const input_buffer, stream_context * const context, size_t * const length)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output_end = NULL;
+    size_t needed = 0;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"'))
+    {
+        return false; /* not a string */
+    }
+
+    input_end = find_string_end(input_buffer, &needed);
+    if (input_end == NULL)
+    {
+        return false;
+    }
+
+    needed += sizeof("");
+    if (needed > context->scratch_size)
+    {
+        size_t new_size = (context->scratch_size == 0) ? 256 : context->scratch_size;
+        unsigned char *new_scratch = NULL;
+        while (new_size < needed)
+        {
+            new_size *= 2;
+        }
+        new_scratch = (unsigned char*)input_buffer->hooks.allocate(new_size);
+        if (new_scratch == NULL)
+        {
+            return false; /* allocation failure */
+        }
+        if (context->scratch != NULL)
+        {
+            input_buffer->hooks.deallocate(context->scratch);
+        }
+        context->scratch = new_scratch;
+        context->scratch_size = new_size;
+    }
+
+    output_end = unescape_string(&input_pointer, input_end, context->scratch);
+    if (output_end == NULL)
+    {
+        input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+        return false;
+    }
+    *output_end = '\0';
+    *length = (size_t)(output_end - context->scratch);
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+    return true;
+}
+
+static cJSON_bool stream_array(parse_buffer * const input_buffer, stream_context * const context)
+{
+    const cJSON_StreamCallbacks *callbacks = context->callbacks;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if ((callbacks->start_array != NULL) && !callbacks->start_array(context->user_data))
+    {
+        return false; /* aborted by the callback */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!stream_value(input_buffer, context))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        return false; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return (callbacks->end_array == NULL) || callbacks->end_array(context->user_data);
+}
+
+static cJSON_bool stream_object(parse_buffer * const input_buffer, stream_context * const context)
+{
+    const cJSON_StreamCallbacks *callbacks = context->callbacks;
+    size_t length = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if ((callbacks->start_object != NULL) && !callbacks->start_object(context->user_data))
+    {
+        return false; /* aborted by the callback */
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated members */
+    do
+    {
+        if (cannot_access_at_index(input_buffer, 1))
+        {
+            return false; /* nothing comes after the comma */
+        }
+
+        /* parse the name of the child */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!stream_string(input_buffer, context, &length))
+        {
+            return false; /* failed to parse name */
+        }
+        if ((callbacks->key != NULL) && !callbacks->key(context->user_data, (const char*)context->scratch, length))
+        {
+            return false;
+        }
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            return false; /* invalid object */
+        }
+
+        /* parse the value */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!stream_value(input_buffer, context))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        return false; /* expected end of object */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return (callbacks->end_object == NULL) || callbacks->end_object(context->user_data);
+}
+
+/* Streaming counterpart of parse_value: reports the value to the callbacks instead of building an item. */
+static cJSON_bool stream_value(parse_buffer * const input_buffer, stream_context * const context)
+{
+    const cJSON_StreamCallbacks *callbacks = context->callbacks;
+    void *user_data = context->user_data;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return (callbacks->null == NULL) || callbacks->null(user_data);
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        input_buffer->offset += 5;
+        return (callbacks->boolean == NULL) || callbacks->boolean(user_data, false);
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return (callbacks->boolean == NULL) || callbacks->boolean(user_data, true);
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        size_t length = 0;
+        if (!stream_string(input_buffer, context, &length))
+        {
+            return false;
+        }
+        return (callbacks->string == NULL) || callbacks->string(user_data, (const char*)context->scratch, length);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        cJSON number;
+        memset(&number, '\0', sizeof(number));
+        if (!parse_number(&number, input_buffer))
+        {
+            return false;
+        }
+        return (callbacks->number == NULL) || callbacks->number(user_data, number.valuedouble, number.valueint);
+    }
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return stream_array(input_buffer, context);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return stream_object(input_buffer, context);
+    }
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ParseStream(const char *value, size_t buffer_length, const cJSON_StreamCallbacks *callbacks, void *user_data)
+{
+    return cJSON_ParseStreamOpts(value, buffer_length, callbacks, user_data, NULL);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ParseStreamOpts(const char *value, size_t buffer_length, const cJSON_StreamCallbacks *callbacks, void *user_data, const char **return_parse_end)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    stream_context context = { 0, 0, 0, 0 };
+    cJSON_bool success = false;
+    size_t position = 0;
+
+    /* reset error position, only when it is reported globally */
+    if (return_parse_end == NULL)
+    {
+        global_error.json = NULL;
+        global_error.position = 0;
+    }
+
+    if ((value == NULL) || (0 == buffer_length) || (callbacks == NULL))
+    {
+        return false;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    context.callbacks = callbacks;
+    context.user_data = user_data;
+
+    success = stream_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), &context);
+
+    if (context.scratch != NULL)
+    {
+        buffer.hooks.deallocate(context.scratch);
+    }
+
+    position = success ? buffer.offset : ((buffer.offset < buffer.length) ? buffer.offset : buffer.length - 1);
+    if (return_parse_end != NULL)
+    {
+        *return_parse_end = value + position;
+    }
+    else if (!success)
+    {
+        global_error.json = (const unsigned char*)value;
+        global_error.position = position;
+    }
+
+    return success;
+}
+
+/* Tape: a read-only document as one flat array of 64 bit words in document order, instead of a
+ * tree of separately allocated items. The top byte of a word is its tag, the low 56 bits its payload:
+ *   'n', 't', 'f'   null, true, false
+ *   'l', 'd'        number, followed by a word holding it as a long long or as a double
+ *   '\"'            string or key, payload is the offset of its characters in the high 32 bits and its
+ *                   length in the low 24 bits
+ *   's'             string or key too long or too far for that, payload is its length, followed by a
+ *                   word holding the offset
+ *   '[', '{'        start of an array/object, payload is the distance to its end word
+ *   ']', '}'        end of an array/object, payload is the distance back to its start word
+ *   'r'             end of the tape, after the root value
+ * Members of an object are a key followed by its value. String offsets below the input length are into
+ * the input, the others into the strings past it that had escape sequences and were unescaped. */
+typedef unsigned long long tape_word;
+
+#define TAPE_PAYLOAD_MASK ((((tape_word)1) << 56) - 1)
+#define tape_make(tag, payload) ((((tape_word)(unsigned char)(tag)) << 56) | ((tape_word)(payload) & TAPE_PAYLOAD_MASK))
+#define tape_tag(word) ((unsigned char)((word) >> 56))
+#define tape_payload(word) ((size_t)((word) & TAPE_PAYLOAD_MASK))
+#define tape_is_end(word) ((tape_tag(word) == ']') || (tape_tag(word) == '}') || (tape_tag(word) == 'r'))
+#define tape_words(item) ((const tape_word*)(const void*)(item))
+#define tape_item(word) ((const cJSON_TapeItem*)(const void*)(word))
+/* a key is always a string, so the lookups find its value without going through tape_skip */
+#define tape_string_words(word) ((tape_tag(word) == 's') ? 2 : 1)
+
+#define TAPE_LENGTH_BITS 24
+#define TAPE_LENGTH_MASK ((((tape_word)1) << TAPE_LENGTH_BITS) - 1)
+#define TAPE_OFFSET_MAX ((((tape_word)1) << (56 - TAPE_LENGTH_BITS)) - 1)
+
+/* unescaped strings are rare in practice, so their buffer starts small */
+#define TAPE_STRINGS_INITIAL_SIZE 4096
+
+struct cJSON_Tape
+{
+    internal_hooks hooks;
+    tape_word *words;
+    size_t count;
+    size_t capacity;
+    const unsigned char *input;
+    size_t input_length;
+    unsigned char *strings; /* allocated for the first string with escape sequences */
+    size_t strings_length;
+    size_t strings_capacity;
+};
+
+/* Moves the first used bytes of an allocation into one of size bytes, NULL on failure (keeping the old one) */
+static void *tape_reallocate(const internal_hooks * const hooks, void *pointer, size_t used, size_t size)
+{
+    void *resized = NULL;
+
+    if (hooks->reallocate != NULL)
+    {
+        return hooks->reallocate(pointer, size);
+    }
+
+    resized = hooks->allocate(size);
+    if ((resized != NULL) && (pointer != NULL))
+    {
+        memcpy(resized, pointer, used);
+        hooks->deallocate(pointer);
+    }
+    return resized;
+}
+
+static cJSON_bool tape_resize(cJSON_Tape * const tape, size_t capacity)
+{
+    tape_word *words = NULL;
+
+    if (capacity > ((size_t)-1) / sizeof(tape_word))
+    {
+        return false; /* overflow */
+    }
+    words = (tape_word*)tape_reallocate(&tape->hooks, tape->words, tape->count * sizeof(tape_word), capacity * sizeof(tape_word));
+    if (words == NULL)
+    {
+        return false; /* allocation failure */
+    }
+
+    tape->words = words;
+    tape->capacity = capacity;
+    return true;
+}
+
+/* Makes room for size more bytes of unescaped strings */
+static cJSON_bool tape_reserve_strings(cJSON_Tape * const tape, size_t size)
+{
+    size_t capacity = (tape->strings_capacity == 0) ? TAPE_STRINGS_INITIAL_SIZE : tape->strings_capacity;
+    unsigned char *strings = NULL;
+
+    if (size > ((size_t)-1) - tape->input_length - tape->strings_length)
+    {
+        return false; /* overflow of the offsets */
+    }
+    if ((tape->strings != NULL) && (tape->strings_length + size <= tape->strings_capacity))
+    {
+        return true;
+    }
+    while (capacity < tape->strings_length + size)
+    {
+        if (capacity > ((size_t)-1) / 2)
+        {
+            capacity = tape->strings_length + size;
+            break;
+        }
+        capacity *= 2;
+    }
+
+    strings = (unsigned char*)tape_reallocate(&tape->hooks, tape->strings, tape->strings_length, capacity);
+    if (strings == NULL)
+    {
+        return false; /* allocation failure */
+    }
+
+    tape->strings = strings;
+    tape->strings_capacity = capacity;
+    return true;
+}
+
+static cJSON_bool tape_push(cJSON_Tape * const tape, tape_word word)
+{
+    if ((tape->count == tape->capacity) && !tape_resize(tape, (tape->capacity == 0) ? 256 : tape->capacity * 2))
+    {
+        return false;
+    }
+
+    tape->words[tape->count++] = word;
+    return true;
+}
+
+/* A tag word and the raw bytes of value in the word after it */
+static cJSON_bool tape_push_with(cJSON_Tape * const tape, tape_word word, const void *value, size_t size)
+{
+    tape_word data = 0;
+    memcpy(&data, value, size);
+    return tape_push(tape, word) && tape_push(tape, data);
+}
+
+static cJSON_bool tape_push_number(cJSON_Tape * const tape, double valuedouble, long long valueint)
+{
+    double integral = (double)valueint;
+
+    /* integral numbers keep their exact valueint, valuedouble is derived from it as parse_integer does */
+    if (memcmp(&integral, &valuedouble, sizeof(double)) == 0)
+    {
+        return tape_push_with(tape, tape_make('l', 0), &valueint, sizeof(valueint));
+    }
+    return tape_push_with(tape, tape_make('d', 0), &valuedouble, sizeof(valuedouble));
+}
+
+/* One word when the offset and length fit in it, two otherwise */
+static cJSON_bool tape_push_string(cJSON_Tape * const tape, size_t offset, size_t length)
+{
+    if (((tape_word)offset <= TAPE_OFFSET_MAX) && ((tape_word)length <= TAPE_LENGTH_MASK))
+    {
+        return tape_push(tape, tape_make('\"', ((tape_word)offset << TAPE_LENGTH_BITS) | (tape_word)length));
+    }
+    return tape_push(tape, tape_make('s', length)) && tape_push(tape, (tape_word)offset);
+}
+
+static cJSON_bool tape_value(parse_buffer * const input_buffer, cJSON_Tape * const tape);
+
+/* Strings without escape sequences stay in the input, the others are unescaped into the tape's strings. */
+static cJSON_bool tape_string(parse_buffer * const input_buffer, cJSON_Tape * const tape)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    size_t offset = (size_t)(input_pointer - input_buffer->content);
+    size_t length = 0;
+
+    /* errors are reported past the opening quote, as parse_string does */
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"'))
+    {
+        input_buffer->offset++;
+        return false; /* not a string */
+    }
+
+    input_end = find_string_end(input_buffer, &length);
+    if (input_end == NULL)
+    {
+        input_buffer->offset++;
+        return false;
+    }
+
+    /* without escape sequences, find_string_end counts the raw length plus the terminator */
+    if (length == (size_t)(input_end - input_pointer) + 1)
+    {
+        length--;
+    }
+    else
+    {
+        unsigned char *output = NULL;
+        unsigned char *output_end = NULL;
+
+        if (!tape_reserve_strings(tape, length))
+        {
+            return false; /* allocation failure */
+        }
+        output = tape->strings + tape->strings_length;
+        output_end = unescape_string(&input_pointer, input_end, output);
+        if (output_end == NULL)
+        {
+            input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+            return false;
+        }
+        offset = tape->input_length + tape->strings_length;
+        length = (size_t)(output_end - output);
+        tape->strings_length += length;
+    }
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+    return tape_push_string(tape, offset, length);
+}
+
+/* Pushes the end word of the array/object started at start, and points the start word at it */
+static cJSON_bool tape_close(cJSON_Tape * const tape, size_t start, unsigned char tag)
+{
+    size_t distance = tape->count - start;
+    tape->words[start] = tape_make(tape_tag(tape->words[start]), distance);
+    return tape_push(tape, tape_make(tag, distance));
+}
+
+static cJSON_bool tape_array(parse_buffer * const input_buffer, cJSON_Tape * const tape)
+{
+    size_t start = tape->count;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (!tape_push(tape, tape_make('[', 0)))
+    {
+        return false;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ']'))
+    {
+        /* empty array */
+        goto success;
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated array elements */
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!tape_value(input_buffer, tape))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || buffer_at_offset(input_buffer)[0] != ']')
+    {
+        return false; /* expected end of array */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return tape_close(tape, start, ']');
+}
+
+static cJSON_bool tape_object(parse_buffer * const input_buffer, cJSON_Tape * const tape)
+{
+    size_t start = tape->count;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    if (!tape_push(tape, tape_make('{', 0)))
+    {
+        return false;
+    }
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '}'))
+    {
+        goto success; /* empty object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    /* loop through the comma separated members */
+    do
+    {
+        if (cannot_access_at_index(input_buffer, 1))
+        {
+            return false; /* nothing comes after the comma */
+        }
+
+        /* parse the name of the child */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!tape_string(input_buffer, tape))
+        {
+            return false; /* failed to parse name */
+        }
+        buffer_skip_whitespace(input_buffer);
+
+        if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+        {
+            return false; /* invalid object */
+        }
+
+        /* parse the value */
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (!tape_value(input_buffer, tape))
+        {
+            return false; /* failed to parse value */
+        }
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '}'))
+    {
+        return false; /* expected end of object */
+    }
+
+success:
+    input_buffer->depth--;
+    input_buffer->offset++;
+
+    return tape_close(tape, start, '}');
+}
+
+/* Tape counterpart of parse_value: appends the value to the tape instead of building an item. */
+static cJSON_bool tape_value(parse_buffer * const input_buffer, cJSON_Tape * const tape)
+{
+    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    {
+        return false; /* no input */
+    }
+
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return tape_push(tape, tape_make('n', 0));
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        input_buffer->offset += 5;
+        return tape_push(tape, tape_make('f', 0));
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        input_buffer->offset += 4;
+        return tape_push(tape, tape_make('t', 0));
+    }
+    /* string */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '\"'))
+    {
+        return tape_string(input_buffer, tape);
+    }
+    /* number */
+    if (can_access_at_index(input_buffer, 0) && ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))))
+    {
+        cJSON number;
+        memset(&number, '\0', sizeof(number));
+        if (!parse_number(&number, input_buffer))
+        {
+            return false;
+        }
+        return tape_push_number(tape, number.valuedouble, number.valueint);
+    }
+    /* array */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '['))
+    {
+        return tape_array(input_buffer, tape);
+    }
+    /* object */
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == '{'))
+    {
+        return tape_object(input_buffer, tape);
+    }
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, 0, 0, 0 };
+    cJSON_Tape *tape = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if ((value == NULL) || (0 == buffer_length))
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    tape = (cJSON_Tape*)global_hooks.allocate(sizeof(cJSON_Tape));
+    if (tape == NULL)
+    {
+        goto fail;
+    }
+    memset(tape, '\0', sizeof(cJSON_Tape));
+    tape->hooks = global_hooks;
+    tape->input = buffer.content;
+    tape->input_length = buffer.length;
+
+    if (!tape_value(buffer_skip_whitespace(skip_utf8_bom(&buffer)), tape) || !tape_push(tape, tape_make('r', 0)))
+    {
+        goto fail;
+    }
+
+    /* the tape is never appended to again, give back what the doubling overshot (keeping it on failure) */
+    tape_resize(tape, tape->count);
+    if ((tape->strings_length > 0) && (tape->strings_length < tape->strings_capacity))
+    {
+        unsigned char *strings = (unsigned char*)tape_reallocate(&tape->hooks, tape->strings, tape->strings_length, tape->strings_length);
+        if (strings != NULL)
+        {
+            tape->strings = strings;
+            tape->strings_capacity = tape->strings_length;
+        }
+    }
+
+    return tape;
+
+fail:
+    cJSON_DeleteTape(tape);
+
+    if (value != NULL)
+    {
+        global_error.json = (const unsigned char*)value;
+        global_error.position = 0;
+        if (buffer.offset < buffer.length)
+        {
+            global_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            global_error.position = buffer.length - 1;
+        }
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape)
+{
+    if (tape == NULL)
+    {
+        return;
+    }
+
+    if (tape->strings != NULL)
+    {
+        tape->hooks.deallocate(tape->strings);
+    }
+    if (tape->words != NULL)
+    {
+        tape->hooks.deallocate(tape->words);
+    }
+    tape->hooks.deallocate(tape);
+}
+
+CJSON_PUBLIC(size_t) cJSON_TapeMemory(const cJSON_Tape *tape)
 {
-    return print_string_ptr((unsigned char*)item->valuestring, p);
-}
+    if (tape == NULL)
+    {
+        return 0;
+    }
 
-/* Predeclare these prototypes. */
-static cJSON_bool parse_value(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_value(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
-static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+    return sizeof(cJSON_Tape) + tape->capacity * sizeof(tape_word) + tape->strings_capacity;
+}
 
-/* Utility to jump whitespace and cr/lf */
-static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeRoot(const cJSON_Tape *tape)
 {
-    if ((buffer == NULL) || (buffer->content == NULL))
+    if (tape == NULL)
     {
         return NULL;
     }
 
-    if (cannot_access_at_index(buffer, 0))
-    {
-        return buffer;
-    }
+    return tape_item(tape->words);
+}
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+CJSON_PUBLIC(int) cJSON_TapeGetType(const cJSON_TapeItem *item)
+{
+    if (item == NULL)
     {
-       buffer->offset++;
+        return cJSON_Invalid;
+    }
+
+    switch (tape_tag(*tape_words(item)))
+    {
+        case 'n':
+            return cJSON_NULL;
+        case 'f':
+            return cJSON_False;
+        case 't':
+            return cJSON_True;
+        case 'l':
+        case 'd':
+            return cJSON_Number;
+        case '\"':
+        case 's':
+            return cJSON_String;
+        case '[':
+            return cJSON_Array;
+        case '{':
+            return cJSON_Object;
+        default:
+            return cJSON_Invalid;
     }
+}
 
-    if (buffer->offset == buffer->length)
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeChild(const cJSON_TapeItem *item)
+{
+    const tape_word *word = tape_words(item);
+
+    if ((item == NULL) || ((tape_tag(*word) != '[') && (tape_tag(*word) != '{')) || tape_is_end(word[1]))
     {
-        buffer->offset--;
+        return NULL;
     }
 
-    return buffer;
+    return tape_item(word + 1);
 }
 
-/* skip the UTF-8 BOM (byte order mark) if it is at the beginning of a buffer */
-static parse_buffer *skip_utf8_bom(parse_buffer * const buffer)
+/* The word after the item at word. Comparisons rather than a switch, which compiles to a jump
+ * table whose indirect branch mispredicts as keys and values alternate. */
+static const tape_word *tape_skip(const tape_word *word)
 {
-    if ((buffer == NULL) || (buffer->content == NULL) || (buffer->offset != 0))
+    unsigned char tag = tape_tag(*word);
+
+    if ((tag == '[') || (tag == '{'))
     {
-        return NULL;
+        return word + tape_payload(*word) + 1;
     }
+    return word + (((tag == 'l') || (tag == 'd') || (tag == 's')) ? 2 : 1);
+}
 
-    if (can_access_at_index(buffer, 4) && (strncmp((const char*)buffer_at_offset(buffer), "\xEF\xBB\xBF", 3) == 0))
+/* Same, NULL past the last child */
+static const tape_word *tape_next(const tape_word *word)
+{
+    word = tape_skip(word);
+    return tape_is_end(*word) ? NULL : word;
+}
+
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeNext(const cJSON_TapeItem *item)
+{
+    if (item == NULL)
     {
-        buffer->offset += 3;
+        return NULL;
     }
 
-    return buffer;
+    return tape_item(tape_next(tape_words(item)));
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated)
+CJSON_PUBLIC(int) cJSON_TapeGetArraySize(const cJSON_TapeItem *array)
 {
-    size_t buffer_length;
+    const cJSON_TapeItem *child = NULL;
+    size_t size = 0;
 
-    if (NULL == value)
+    if (array == NULL)
     {
-        return NULL;
+        return 0;
     }
 
-    /* Adding null character size due to require_null_terminated. */
-    buffer_length = strlen(value) + sizeof("");
+    for (child = cJSON_TapeChild(array); child != NULL; child = cJSON_TapeNext(child))
+    {
+        size++;
+    }
 
-    return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
+    /* an object's children are its keys and values */
+    if (tape_tag(*tape_words(array)) == '{')
+    {
+        size /= 2;
+    }
+
+    return (int)size;
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* The characters and length of the string at word */
+static const char *tape_string_at(const cJSON_Tape * const tape, const tape_word *word, size_t *length)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
-    cJSON *item = NULL;
+    size_t offset = 0;
 
-    /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+    if (tape_tag(*word) == '\"')
+    {
+        offset = (size_t)(tape_payload(*word) >> TAPE_LENGTH_BITS);
+        *length = (size_t)(*word & TAPE_LENGTH_MASK);
+    }
+    else
+    {
+        offset = (size_t)word[1];
+        *length = tape_payload(*word);
+    }
 
-    if (value == NULL || 0 == buffer_length)
+    if (offset < tape->input_length)
     {
-        goto fail;
+        return (const char*)tape->input + offset;
     }
+    return (const char*)tape->strings + (offset - tape->input_length);
+}
 
-    buffer.content = (const unsigned char*)value;
-    buffer.length = buffer_length;
-    buffer.offset = 0;
-    buffer.hooks = global_hooks;
+/* Whether the length characters of string are the zero terminated name. Keys are short, a byte
+ * loop beats calling strlen for name and then memcmp. */
+static cJSON_bool tape_string_equals(const char *string, size_t length, const char *name)
+{
+    size_t i = 0;
 
-    item = cJSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
+    for (i = 0; i < length; i++)
     {
-        goto fail;
+        if ((name[i] == '\0') || (name[i] != string[i]))
+        {
+            return false;
+        }
     }
+    return name[length] == '\0';
+}
 
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+/* The lookups walk the words directly rather than through cJSON_TapeChild/cJSON_TapeNext */
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeGetObjectItemCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeItem *object, const char * const string)
+{
+    const tape_word *key = NULL;
+    const tape_word *value = NULL;
+    const char *key_string = NULL;
+    size_t key_length = 0;
+    size_t string_length = 0;
+
+    if ((tape == NULL) || (object == NULL) || (string == NULL) || (tape_tag(*tape_words(object)) != '{'))
     {
-        /* parse failure. ep is set. */
-        goto fail;
+        return NULL;
     }
+    /* the key lengths are in the words, so most keys are rejected without reading their characters */
+    string_length = strlen(string);
 
-    /* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-    if (require_null_terminated)
+    for (key = tape_words(object) + 1; !tape_is_end(*key); key = tape_skip(value))
     {
-        buffer_skip_whitespace(&buffer);
-        if ((buffer.offset >= buffer.length) || buffer_at_offset(&buffer)[0] != '\0')
+        value = key + tape_string_words(*key);
+        key_string = tape_string_at(tape, key, &key_length);
+        if ((key_length == string_length) && (memcmp(key_string, string, string_length) == 0))
         {
-            goto fail;
+            return tape_item(value);
         }
     }
-    if (return_parse_end)
-    {
-        *return_parse_end = (const char*)buffer_at_offset(&buffer);
-    }
 
-    return item;
+    return NULL;
+}
 
-fail:
-    if (item != NULL)
+CJSON_PUBLIC(int) cJSON_TapeGetObjectItemsCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeItem *object, const char * const *names, const cJSON_TapeItem **items, int count)
+{
+    const tape_word *key = NULL;
+    const tape_word *value = NULL;
+    const char *key_string = NULL;
+    size_t key_length = 0;
+    int found = 0;
+    int i = 0;
+
+    if ((tape == NULL) || (object == NULL) || (names == NULL) || (items == NULL) || (count <= 0))
     {
-        cJSON_Delete(item);
+        return 0;
     }
 
-    if (value != NULL)
+    for (i = 0; i < count; i++)
     {
-        error local_error;
-        local_error.json = (const unsigned char*)value;
-        local_error.position = 0;
+        items[i] = NULL;
+    }
+    if (tape_tag(*tape_words(object)) != '{')
+    {
+        return 0;
+    }
 
-        if (buffer.offset < buffer.length)
-        {
-            local_error.position = buffer.offset;
-        }
-        else if (buffer.length > 0)
+    /* single pass over the members, stopping as soon as every name is resolved */
+    for (key = tape_words(object) + 1; !tape_is_end(*key) && (found < count); key = tape_skip(value))
+    {
+        value = key + tape_string_words(*key);
+        key_string = tape_string_at(tape, key, &key_length);
+        for (i = 0; i < count; i++)
         {
-            local_error.position = buffer.length - 1;
+            if ((items[i] == NULL) && (names[i] != NULL) && tape_string_equals(key_string, key_length, names[i]))
+            {
+                items[i] = tape_item(value);
+                found++;
+                break;
+            }
         }
+    }
 
-        if (return_parse_end != NULL)
-        {
-            *return_parse_end = (const char*)local_error.json + local_error.position;
-        }
+    return found;
+}
 
-        global_error = local_error;
+CJSON_PUBLIC(const char *) cJSON_TapeGetStringValue(const cJSON_Tape *tape, const cJSON_TapeItem *item, size_t *length)
+{
+    const tape_word *word = tape_words(item);
+    const char *string = NULL;
+    size_t string_length = 0;
+
+    if ((tape == NULL) || (item == NULL) || ((tape_tag(*word) != '\"') && (tape_tag(*word) != 's')))
+    {
+        return NULL;
     }
 
-    return NULL;
+    string = tape_string_at(tape, word, &string_length);
+    if (length != NULL)
+    {
+        *length = string_length;
+    }
+    return string;
 }
 
-/* Default options for cJSON_Parse */
-CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
+CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(const cJSON_TapeItem *item)
 {
-    return cJSON_ParseWithOpts(value, 0, 0);
+    const tape_word *word = tape_words(item);
+    long long valueint = 0;
+    double valuedouble = 0;
+
+    if ((item != NULL) && (tape_tag(*word) == 'l'))
+    {
+        memcpy(&valueint, &word[1], sizeof(valueint));
+        return (double)valueint;
+    }
+    if ((item != NULL) && (tape_tag(*word) == 'd'))
+    {
+        memcpy(&valuedouble, &word[1], sizeof(valuedouble));
+        return valuedouble;
+    }
+
+    return (double) NAN;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_length)
+CJSON_PUBLIC(long long) cJSON_TapeGetIntValue(const cJSON_TapeItem *item)
 {
-    return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
+    const tape_word *word = tape_words(item);
+    long long valueint = 0;
+    double valuedouble = 0;
+
+    if ((item != NULL) && (tape_tag(*word) == 'l'))
+    {
+        memcpy(&valueint, &word[1], sizeof(valueint));
+        return valueint;
+    }
+    if ((item != NULL) && (tape_tag(*word) == 'd'))
+    {
+        /* same saturation as valueint of parsed items */
+        memcpy(&valuedouble, &word[1], sizeof(valuedouble));
+        if (valuedouble >= LLONG_MAX)
+        {
+            return LLONG_MAX;
+        }
+        if (valuedouble <= (double)LLONG_MIN)
+        {
+            return LLONG_MIN;
+        }
+        return (long long)valuedouble;
+    }
+
+    return 0;
 }
 
 #define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
@@ -1500,7 +3370,7 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL)
         {
             goto fail; /* allocation failure */
@@ -1553,7 +3423,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        parse_delete(input_buffer, head);
     }
 
     return false;
@@ -1626,6 +3496,7 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
 {
     cJSON *head = NULL; /* linked list head */
     cJSON *current_item = NULL;
+    int key_flags = 0; /* of the current item, which parse_value overwrites the type of */
 
     if (input_buffer->depth >= CJSON_NESTING_LIMIT)
     {
@@ -1658,7 +3529,7 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL)
         {
             goto fail; /* allocation failure */
@@ -1684,18 +3555,15 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
         }
 
         /* parse the name of the child */
+        key_flags = 0;
         input_buffer->offset++;
         buffer_skip_whitespace(input_buffer);
-        if (!parse_string(current_item, input_buffer))
+        if (!parse_key(current_item, input_buffer, &key_flags))
         {
             goto fail; /* failed to parse name */
         }
         buffer_skip_whitespace(input_buffer);
 
-        /* swap valuestring and string, because we parsed the name */
-        current_item->string = current_item->valuestring;
-        current_item->valuestring = NULL;
-
         if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
         {
             goto fail; /* invalid object */
@@ -1708,6 +3576,7 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
         {
             goto fail; /* failed to parse value */
         }
+        current_item->type |= key_flags;
         buffer_skip_whitespace(input_buffer);
     }
     while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
@@ -1733,7 +3602,9 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        /* so that cJSON_Delete leaves a name it does not own alone */
+        current_item->type |= key_flags;
+        parse_delete(input_buffer, head);
     }
 
     return false;
@@ -1953,6 +3824,159 @@ CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *st
     return cJSON_GetObjectItem(object, string) ? 1 : 0;
 }
 
+CJSON_PUBLIC(int) cJSON_GetObjectItemsCaseSensitive(const cJSON * const object, const char * const *names, cJSON **items, int count)
+{
+    cJSON *current_element = NULL;
+    int found = 0;
+    int i = 0;
+
+    if ((object == NULL) || (names == NULL) || (items == NULL) || (count <= 0))
+    {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        items[i] = NULL;
+    }
+
+    /* single pass over the members, stopping as soon as every name is resolved */
+    for (current_element = object->child; (current_element != NULL) && (found < count); current_element = current_element->next)
+    {
+        if (current_element->string == NULL)
+        {
+            continue;
+        }
+        for (i = 0; i < count; i++)
+        {
+            if ((items[i] == NULL) && (names[i] != NULL) && (strcmp(names[i], current_element->string) == 0))
+            {
+                items[i] = current_element;
+                found++;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+/* Hashed index over the members of an object: open addressing with linear probing,
+ * sized to at most half full. */
+typedef struct
+{
+    size_t hash;
+    cJSON *item;
+} object_index_slot;
+
+struct cJSON_ObjectIndex
+{
+    internal_hooks hooks;
+    size_t capacity; /* power of two */
+    object_index_slot *slots;
+};
+
+/* hash_bytes of a zero terminated key */
+static size_t hash_key(const unsigned char *key)
+{
+    return hash_bytes(key, strlen((const char*)key));
+}
+
+CJSON_PUBLIC(cJSON_ObjectIndex *) cJSON_CreateObjectIndex(const cJSON * const object)
+{
+    cJSON_ObjectIndex *index = NULL;
+    cJSON *current_element = NULL;
+    size_t member_count = 0;
+    size_t capacity = 8;
+
+    if (!cJSON_IsObject(object))
+    {
+        return NULL;
+    }
+
+    member_count = (size_t)cJSON_GetArraySize(object);
+    while (capacity < 2 * member_count)
+    {
+        capacity *= 2;
+    }
+
+    index = (cJSON_ObjectIndex*)global_hooks.allocate(sizeof(cJSON_ObjectIndex));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->hooks = global_hooks;
+    index->capacity = capacity;
+    index->slots = (object_index_slot*)global_hooks.allocate(capacity * sizeof(object_index_slot));
+    if (index->slots == NULL)
+    {
+        global_hooks.deallocate(index);
+        return NULL;
+    }
+    memset(index->slots, '\0', capacity * sizeof(object_index_slot));
+
+    for (current_element = object->child; current_element != NULL; current_element = current_element->next)
+    {
+        size_t hash = 0;
+        size_t slot = 0;
+        if (current_element->string == NULL)
+        {
+            continue;
+        }
+
+        hash = hash_key((const unsigned char*)current_element->string);
+        slot = hash & (capacity - 1);
+        while (index->slots[slot].item != NULL)
+        {
+            if ((index->slots[slot].hash == hash) && (strcmp(index->slots[slot].item->string, current_element->string) == 0))
+            {
+                break; /* duplicate key, the first one wins like in get_object_item */
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (index->slots[slot].item == NULL)
+        {
+            index->slots[slot].hash = hash;
+            index->slots[slot].item = current_element;
+        }
+    }
+
+    return index;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_GetIndexedItem(const cJSON_ObjectIndex * const index, const char * const string)
+{
+    size_t hash = 0;
+    size_t slot = 0;
+
+    if ((index == NULL) || (string == NULL))
+    {
+        return NULL;
+    }
+
+    hash = hash_key((const unsigned char*)string);
+    for (slot = hash & (index->capacity - 1); index->slots[slot].item != NULL; slot = (slot + 1) & (index->capacity - 1))
+    {
+        if ((index->slots[slot].hash == hash) && (strcmp(index->slots[slot].item->string, string) == 0))
+        {
+            return index->slots[slot].item;
+        }
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteObjectIndex(cJSON_ObjectIndex *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+
+    index->hooks.deallocate(index->slots);
+    index->hooks.deallocate(index);
+}
+
 /* Utility for array list handling. */
 static void suffix_object(cJSON *prev, cJSON *item)
 {
@@ -1977,7 +4001,7 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
-    reference->type |= cJSON_IsReference;
+    reference->type = (reference->type & ~cJSON_OwnsArena) | cJSON_IsReference;
     reference->next = reference->prev = NULL;
     return reference;
 }
@@ -2469,17 +4493,17 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
         item->valuedouble = num;
 
         /* use saturation in case of overflow */
-        if (num >= LONG_MAX)
+        if (num >= LLONG_MAX)
         {
-            item->valueint = LONG_MAX;
+            item->valueint = LLONG_MAX;
         }
-        else if (num <= (double)LONG_MIN)
+        else if (num <= (double)LLONG_MIN)
         {
-            item->valueint = LONG_MIN;
+            item->valueint = LLONG_MIN;
         }
         else
         {
-            item->valueint = (int)num;
+            item->valueint = (long long)num;
         }
     }
 
@@ -2763,7 +4787,7 @@ cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
+    newitem->type = item->type & (~(cJSON_IsReference | cJSON_OwnsArena));
     newitem->valueint = item->valueint;
     newitem->valuedouble = item->valuedouble;
     if (item->valuestring)
@@ -98,6 +98,7 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_OwnsArena 1024 /* root of a tree parsed into an arena of its own, which cJSON_Delete releases */
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -114,7 +115,8 @@ typedef struct cJSON
     /* The item's string, if type==cJSON_String  and type == cJSON_Raw */
     char *valuestring;
     /* writing to valueint is DEPRECATED, use cJSON_SetNumberValue instead */
-    long valueint;
+    /* integral numbers that fit in 64 bits (e.g. OSM ids) are parsed into valueint exactly */
+    long long valueint;
     /* The item's number, if type==cJSON_Number */
     double valuedouble;
 
@@ -158,6 +160,94 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
 
+/* Arena parsing: all items and strings of a document are bump-allocated from a few large blocks
+ * owned by the arena, and released together with cJSON_ResetArena/cJSON_DeleteArena.
+ * Trees parsed this way must NOT be passed to cJSON_Delete or to any function that frees or
+ * replaces items (cJSON_DeleteItemFrom*, cJSON_Replace*, cJSON_SetValuestring, ...).
+ * The blocks themselves come from the hooks set when the arena was created. */
+typedef struct cJSON_Arena cJSON_Arena;
+#ifndef CJSON_ARENA_DEFAULT_BLOCK_SIZE
+#define CJSON_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+#endif
+/* block_size of 0 selects CJSON_ARENA_DEFAULT_BLOCK_SIZE */
+CJSON_PUBLIC(cJSON_Arena *) cJSON_CreateArena(size_t block_size);
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthArena(const char *value, size_t buffer_length, cJSON_Arena *arena);
+/* Release every tree parsed into the arena, keeping one block for reuse. */
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena);
+CJSON_PUBLIC(void) cJSON_DeleteArena(cJSON_Arena *arena);
+
+/* Parsing without a copy per string.
+ * cJSON_ParseInSitu unescapes the strings and names in place in value, which must stay alive and untouched
+ * as long as the tree: the items point into it. Its content is undefined after a failed parse. The items
+ * are bump-allocated from arena, or when it is NULL from an arena of the tree's own that cJSON_Delete on
+ * the root releases: either way a document takes a few allocations rather than one per item, and the
+ * restrictions of arena trees apply, except that a tree with its own arena is freed with cJSON_Delete.
+ * cJSON_ParseWithLengthInterned leaves value alone and shares one copy of every object member name
+ * between all the trees parsed with the same key table, which must outlive them. It is not thread safe.
+ * Its arena may be NULL to allocate the items with the hooks as usual, which only saves the names.
+ * Strings and names that are not owned by their item are flagged cJSON_IsReference / cJSON_StringIsConst,
+ * which cJSON_Delete honours. */
+typedef struct cJSON_KeyTable cJSON_KeyTable;
+CJSON_PUBLIC(cJSON *) cJSON_ParseInSitu(char *value, size_t buffer_length, cJSON_Arena *arena);
+CJSON_PUBLIC(cJSON_KeyTable *) cJSON_CreateKeyTable(void);
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthInterned(const char *value, size_t buffer_length, cJSON_KeyTable *keys, cJSON_Arena *arena);
+CJSON_PUBLIC(void) cJSON_DeleteKeyTable(cJSON_KeyTable *keys);
+
+/* Streaming (SAX-style) parsing: instead of building a tree, every value is reported to the callbacks
+ * in document order, so memory use does not grow with the size of the input.
+ * Any callback may be NULL. A callback returning 0 aborts the parse.
+ * Keys and strings are zero terminated and only valid for the duration of the callback. */
+typedef struct cJSON_StreamCallbacks
+{
+    cJSON_bool (*start_object)(void *user_data);
+    cJSON_bool (*end_object)(void *user_data);
+    cJSON_bool (*start_array)(void *user_data);
+    cJSON_bool (*end_array)(void *user_data);
+    cJSON_bool (*key)(void *user_data, const char *key, size_t length);
+    cJSON_bool (*string)(void *user_data, const char *string, size_t length);
+    cJSON_bool (*number)(void *user_data, double valuedouble, long long valueint);
+    cJSON_bool (*boolean)(void *user_data, cJSON_bool value);
+    cJSON_bool (*null)(void *user_data);
+} cJSON_StreamCallbacks;
+
+/* Returns 1 if the whole value was parsed. On failure cJSON_GetErrorPtr() points at the error. */
+CJSON_PUBLIC(cJSON_bool) cJSON_ParseStream(const char *value, size_t buffer_length, const cJSON_StreamCallbacks *callbacks, void *user_data);
+/* Same, reporting where the value ended (or where the error is) in return_parse_end instead of
+ * cJSON_GetErrorPtr(), and ignoring what follows the value. Touches no global state when
+ * return_parse_end is given, so several threads may stream at once. */
+CJSON_PUBLIC(cJSON_bool) cJSON_ParseStreamOpts(const char *value, size_t buffer_length, const cJSON_StreamCallbacks *callbacks, void *user_data, const char **return_parse_end);
+
+/* Tape parsing: a read-only alternative to the tree for consumers that only look values up.
+ * The document becomes one flat array of 64 bit words instead of an allocation per value and
+ * string: one word per key, string and literal, two per number. Strings are offsets into the
+ * input unless they have escape sequences, so the input must outlive the tape, and reading them
+ * takes the tape. Items are pointers into the tape, valid until cJSON_DeleteTape.
+ * In an object, the children alternate between key (a string item) and value.
+ * On the OSM contour the tape takes 3.5 times less memory than the tree, but its lookups, which
+ * walk the members like the tree's do, run about 1.4 times slower: keep the tree (or index the
+ * object, see cJSON_CreateObjectIndex) where repeated lookups dominate. */
+typedef struct cJSON_Tape cJSON_Tape;
+typedef struct cJSON_TapeItem cJSON_TapeItem;
+/* Returns NULL on failure, cJSON_GetErrorPtr() then points at the error. */
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length);
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape);
+/* Bytes allocated for the tape */
+CJSON_PUBLIC(size_t) cJSON_TapeMemory(const cJSON_Tape *tape);
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeRoot(const cJSON_Tape *tape);
+/* cJSON_Number, cJSON_String, cJSON_Array, ... as in cJSON.type */
+CJSON_PUBLIC(int) cJSON_TapeGetType(const cJSON_TapeItem *item);
+/* First child of an array or object, and the item after a child. NULL past the last one. */
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeChild(const cJSON_TapeItem *item);
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeNext(const cJSON_TapeItem *item);
+CJSON_PUBLIC(int) cJSON_TapeGetArraySize(const cJSON_TapeItem *array);
+CJSON_PUBLIC(const cJSON_TapeItem *) cJSON_TapeGetObjectItemCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeItem *object, const char * const string);
+CJSON_PUBLIC(int) cJSON_TapeGetObjectItemsCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeItem *object, const char * const *names, const cJSON_TapeItem **items, int count);
+/* The characters are NOT zero terminated. NULL if item is not a string. */
+CJSON_PUBLIC(const char *) cJSON_TapeGetStringValue(const cJSON_Tape *tape, const cJSON_TapeItem *item, size_t *length);
+/* valuedouble and valueint of the number, NAN and 0 if item is not a number */
+CJSON_PUBLIC(double) cJSON_TapeGetNumberValue(const cJSON_TapeItem *item);
+CJSON_PUBLIC(long long) cJSON_TapeGetIntValue(const cJSON_TapeItem *item);
+
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. */
@@ -178,6 +268,15 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string);
+/* Get several items from object in a single pass over its members. Case sensitive.
+ * items[i] receives the item named names[i], or NULL. Returns the number of names found. */
+CJSON_PUBLIC(int) cJSON_GetObjectItemsCaseSensitive(const cJSON * const object, const char * const *names, cJSON **items, int count);
+/* Hashed key index over the members of an object, for O(1) repeated case sensitive lookups in large objects.
+ * The object must not be modified or deleted while the index is in use. */
+typedef struct cJSON_ObjectIndex cJSON_ObjectIndex;
+CJSON_PUBLIC(cJSON_ObjectIndex *) cJSON_CreateObjectIndex(const cJSON * const object);
+CJSON_PUBLIC(cJSON *) cJSON_GetIndexedItem(const cJSON_ObjectIndex * const index, const char * const string);
+CJSON_PUBLIC(void) cJSON_DeleteObjectIndex(cJSON_ObjectIndex *index);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
 
@@ -295,6 +394,10 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
 /* Macro for iterating over an array or object */
 #define cJSON_ArrayForEach(element, array) for(element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
 
+/* Macros for iterating over a tape array, and over the members of a tape object */
+#define cJSON_TapeArrayForEach(element, array) for(element = cJSON_TapeChild(array); element != NULL; element = cJSON_TapeNext(element))
+#define cJSON_TapeObjectForEach(key, value, object) for(key = cJSON_TapeChild(object); (key != NULL) && ((value = cJSON_TapeNext(key)) != NULL); key = cJSON_TapeNext(value))
+
 /* malloc/free objects using the malloc/free functions that have been set with cJSON_InitHooks */
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size);
 CJSON_PUBLIC(void) cJSON_free(void *object);
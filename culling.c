@@ -0,0 +1,59 @@
+#include <math.h>
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "culling.h"
+#include "world.h"
+
+Frustum GetViewFrustum(void) {
+    return FrustumFromMatrix(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+}
+
+// Gribb & Hartmann: every plane is the last row of the matrix plus or minus one of the others.
+// raymath transforms with x' = m0*x + m4*y + m8*z + m12, so rows are (m0, m4, m8, m12), ...
+Frustum FrustumFromMatrix(Matrix m) {
+    const Vector4 rows[4] = {
+        { m.m0, m.m4, m.m8,  m.m12 },
+        { m.m1, m.m5, m.m9,  m.m13 },
+        { m.m2, m.m6, m.m10, m.m14 },
+        { m.m3, m.m7, m.m11, m.m15 },
+    };
+    Frustum frustum;
+    for (size_t axis = 0; axis < 3; axis++) {
+        frustum.planes[2*axis + 0] = Vector4Add(rows[3], rows[axis]);
+        frustum.planes[2*axis + 1] = Vector4Subtract(rows[3], rows[axis]);
+    }
+    return frustum;
+}
+
+bool FrustumContainsBox(const Frustum *frustum, BoundingBox box) {
+    for (size_t i = 0; i < 6; i++) {
+        Vector4 plane = frustum->planes[i];
+        // The corner of the box farthest along the plane normal
+        float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+        float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+        float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+        if (plane.x*x + plane.y*y + plane.z*z + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+float CameraVisibleHeight(Camera3D camera, Vector3 position) {
+    if (camera.projection == CAMERA_ORTHOGRAPHIC) return camera.fovy;
+    return 2.0f * Vector3Distance(camera.position, position) * tanf(0.5f * camera.fovy * DEG2RAD);
+}
+
+size_t CullGridCell(Vector3 position) {
+    const float height = (float)(MAP_LAT_HEIGHT * LAT_TO_METER);
+    const float width = (float)(MAP_LON_WIDTH * LON_TO_METER);
+    float u = floorf((position.z / width + 0.5f) * CULL_GRID_SIZE);
+    float v = floorf((position.x / height + 0.5f) * CULL_GRID_SIZE);
+    size_t column = (size_t)Clamp(u, 0.0f, CULL_GRID_SIZE - 1);
+    size_t row = (size_t)Clamp(v, 0.0f, CULL_GRID_SIZE - 1);
+    return row * CULL_GRID_SIZE + column;
+}
+
+BoundingBox BoundingBoxUnion(BoundingBox a, BoundingBox b) {
+    return (BoundingBox){ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
@@ -0,0 +1,32 @@
+#ifndef CULLING_H_
+#define CULLING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+
+// Uniform grid over the map the static layers are split into, so that whole cells can be culled
+#define CULL_GRID_SIZE 8
+#define CULL_GRID_CELLS (CULL_GRID_SIZE * CULL_GRID_SIZE)
+
+// Planes (a, b, c, d) of the view frustum, pointing inwards: a*x + b*y + c*z + d >= 0 inside
+typedef struct {
+    Vector4 planes[6];
+} Frustum;
+
+// Frustum of the current rlgl modelview and projection, so only valid between BeginMode3D and EndMode3D.
+Frustum GetViewFrustum(void);
+Frustum FrustumFromMatrix(Matrix view_projection);
+// False only if `box` is entirely outside of the frustum.
+bool FrustumContainsBox(const Frustum *frustum, BoundingBox box);
+
+// Height of the world seen by the camera at the distance of `position`, across the whole screen
+float CameraVisibleHeight(Camera3D camera, Vector3 position);
+
+// Grid cell of a world position; positions off the map go to the closest border cell.
+size_t CullGridCell(Vector3 position);
+// Smallest box containing both
+BoundingBox BoundingBoxUnion(BoundingBox a, BoundingBox b);
+
+#endif // CULLING_H_
@@ -0,0 +1,78 @@
+#include "idmap.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+// No OSM element can have this id, so it marks a free slot.
+#define IDMAP_EMPTY INT64_MIN
+#define IDMAP_MIN_CAPACITY 64
+
+// splitmix64 finalizer: OSM ids are mostly sequential, so spread them over the table
+static inline size_t IdMapHash(int64_t id) {
+    uint64_t x = (uint64_t)id;
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+static void IdMapInsertSlot(IdMap *map, int64_t id, size_t index) {
+    size_t mask = map->capacity - 1;
+    size_t slot = IdMapHash(id) & mask;
+    while (map->keys[slot] != IDMAP_EMPTY && map->keys[slot] != id) {
+        slot = (slot + 1) & mask;
+    }
+    if (map->keys[slot] == IDMAP_EMPTY) map->count++;
+    map->keys[slot] = id;
+    map->values[slot] = index;
+}
+
+static void IdMapRehash(IdMap *map, size_t new_capacity) {
+    IdMap old = *map;
+
+    map->keys = malloc(new_capacity * sizeof(*map->keys));
+    map->values = malloc(new_capacity * sizeof(*map->values));
+    assert(map->keys != NULL && map->values != NULL && "Buy more RAM lol");
+    map->capacity = new_capacity;
+    map->count = 0;
+    for (size_t i = 0; i < new_capacity; i++) map->keys[i] = IDMAP_EMPTY;
+
+    for (size_t i = 0; i < old.capacity; i++) {
+        if (old.keys[i] != IDMAP_EMPTY) IdMapInsertSlot(map, old.keys[i], old.values[i]);
+    }
+    IdMapFree(&old);
+}
+
+void IdMapReserve(IdMap *map, size_t count) {
+    // Keep the load factor at or below 1/2 so probe sequences stay short
+    size_t capacity = map->capacity == 0 ? IDMAP_MIN_CAPACITY : map->capacity;
+    while (capacity < 2 * count) capacity *= 2;
+    if (capacity != map->capacity) IdMapRehash(map, capacity);
+}
+
+void IdMapPut(IdMap *map, int64_t id, size_t index) {
+    assert(id != IDMAP_EMPTY);
+    if (2 * (map->count + 1) > map->capacity) IdMapReserve(map, map->count + 1);
+    IdMapInsertSlot(map, id, index);
+}
+
+bool IdMapGet(const IdMap *map, int64_t id, size_t *index) {
+    if (map->capacity == 0 || id == IDMAP_EMPTY) return false;
+
+    size_t mask = map->capacity - 1;
+    size_t slot = IdMapHash(id) & mask;
+    while (map->keys[slot] != IDMAP_EMPTY) {
+        if (map->keys[slot] == id) {
+            *index = map->values[slot];
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+void IdMapFree(IdMap *map) {
+    free(map->keys);
+    free(map->values);
+    *map = (IdMap){0};
+}
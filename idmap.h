@@ -0,0 +1,26 @@
+#ifndef IDMAP_H_
+#define IDMAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Open-addressing (linear probing) hash table mapping 64-bit OSM ids to array indices.
+// Zero-initialize it, optionally reserve, then put/get. Lookups and inserts are O(1)
+// on average, so resolving way node references stays linear in the size of the file.
+typedef struct {
+    int64_t *keys;
+    size_t *values;
+    size_t capacity; // number of slots, always 0 or a power of two
+    size_t count;
+} IdMap;
+
+// Make room for at least `count` entries without rehashing.
+void IdMapReserve(IdMap *map, size_t count);
+// Insert or overwrite the index stored for `id`.
+void IdMapPut(IdMap *map, int64_t id, size_t index);
+// Returns false if `id` was never put in the map.
+bool IdMapGet(const IdMap *map, int64_t id, size_t *index);
+void IdMapFree(IdMap *map);
+
+#endif // IDMAP_H_
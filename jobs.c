@@ -0,0 +1,186 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "nob.h"
+#include "jobs.h"
+
+typedef struct Job Job;
+struct Job {
+    JobFunction run;
+    JobCompletion complete;
+    void *data;
+    Job *next;
+};
+
+struct JobSystem {
+    pthread_t *workers;
+    size_t worker_count;
+
+    // Submitted jobs, first in first out. Workers sleep on `cond` while it is empty.
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    Job *queue_head;
+    Job *queue_tail;
+    bool quit;
+
+    // Finished jobs as a lock-free stack: workers push one job at a time, DrainJobs takes the
+    // whole stack with one exchange. Nothing is ever popped alone, so there is no ABA problem.
+    _Atomic(Job *) completed;
+    atomic_size_t pending;
+};
+
+static void *JobWorker(void *arg) {
+    JobSystem *jobs = arg;
+    for (;;) {
+        pthread_mutex_lock(&jobs->mutex);
+        while (jobs->queue_head == NULL && !jobs->quit) pthread_cond_wait(&jobs->cond, &jobs->mutex);
+        Job *job = jobs->queue_head;
+        if (job != NULL) {
+            jobs->queue_head = job->next;
+            if (jobs->queue_head == NULL) jobs->queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&jobs->mutex);
+        // Quitting only once the queue is empty, so every job's completion gets to run
+        if (job == NULL) break;
+
+        job->run(job->data);
+
+        // Release: everything the job wrote is visible to the thread that takes it
+        Job *head = atomic_load_explicit(&jobs->completed, memory_order_relaxed);
+        do {
+            job->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&jobs->completed, &head, job,
+                                                        memory_order_release, memory_order_relaxed));
+    }
+    return NULL;
+}
+
+JobSystem *StartJobs(size_t worker_count) {
+    if (worker_count == 0) {
+        size_t cores = (size_t)nob_nprocs();
+        worker_count = cores > 1 ? cores - 1 : 1;
+    }
+
+    JobSystem *jobs = NOB_REALLOC(NULL, sizeof(*jobs));
+    NOB_ASSERT(jobs != NULL && "Buy more RAM lol");
+    *jobs = (JobSystem){0};
+    pthread_mutex_init(&jobs->mutex, NULL);
+    pthread_cond_init(&jobs->cond, NULL);
+    atomic_init(&jobs->completed, NULL);
+    atomic_init(&jobs->pending, 0);
+
+    jobs->workers = NOB_REALLOC(NULL, worker_count * sizeof(*jobs->workers));
+    NOB_ASSERT(jobs->workers != NULL && "Buy more RAM lol");
+    for (size_t i = 0; i < worker_count; i++) {
+        if (pthread_create(&jobs->workers[jobs->worker_count], NULL, JobWorker, jobs) != 0) {
+            nob_log(NOB_WARNING, "could only start %zu of %zu job workers", jobs->worker_count, worker_count);
+            break;
+        }
+        jobs->worker_count++;
+    }
+    return jobs;
+}
+
+void SubmitJob(JobSystem *jobs, JobFunction run, JobCompletion complete, void *data) {
+    Job *job = NOB_REALLOC(NULL, sizeof(*job));
+    NOB_ASSERT(job != NULL && "Buy more RAM lol");
+    *job = (Job){ run, complete, data, NULL };
+    atomic_fetch_add_explicit(&jobs->pending, 1, memory_order_relaxed);
+
+    // Without any worker, run it right away; its completion still waits for DrainJobs
+    if (jobs->worker_count == 0) {
+        run(data);
+        Job *head = atomic_load_explicit(&jobs->completed, memory_order_relaxed);
+        job->next = head;
+        atomic_store_explicit(&jobs->completed, job, memory_order_release);
+        return;
+    }
+
+    pthread_mutex_lock(&jobs->mutex);
+    if (jobs->queue_tail != NULL) jobs->queue_tail->next = job;
+    else jobs->queue_head = job;
+    jobs->queue_tail = job;
+    pthread_cond_signal(&jobs->cond);
+    pthread_mutex_unlock(&jobs->mutex);
+}
+
+size_t DrainJobs(JobSystem *jobs) {
+    Job *stack = atomic_exchange_explicit(&jobs->completed, NULL, memory_order_acquire);
+
+    // The stack has the last finished job on top, reverse it to run completions in finishing order
+    Job *list = NULL;
+    while (stack != NULL) {
+        Job *next = stack->next;
+        stack->next = list;
+        list = stack;
+        stack = next;
+    }
+
+    size_t count = 0;
+    while (list != NULL) {
+        Job *next = list->next;
+        if (list->complete != NULL) list->complete(list->data);
+        NOB_FREE(list);
+        list = next;
+        count++;
+    }
+    atomic_fetch_sub_explicit(&jobs->pending, count, memory_order_relaxed);
+    return count;
+}
+
+size_t PendingJobs(const JobSystem *jobs) {
+    return atomic_load_explicit(&jobs->pending, memory_order_relaxed);
+}
+
+void StopJobs(JobSystem *jobs) {
+    pthread_mutex_lock(&jobs->mutex);
+    jobs->quit = true;
+    pthread_cond_broadcast(&jobs->cond);
+    pthread_mutex_unlock(&jobs->mutex);
+    for (size_t i = 0; i < jobs->worker_count; i++) pthread_join(jobs->workers[i], NULL);
+
+    DrainJobs(jobs);
+    pthread_cond_destroy(&jobs->cond);
+    pthread_mutex_destroy(&jobs->mutex);
+    NOB_FREE(jobs->workers);
+    NOB_FREE(jobs);
+}
+
+typedef struct {
+    ParallelFunction function;
+    void *data;
+    size_t count;
+    atomic_size_t next;    // next index to run, taken by whichever thread is free first
+} ParallelWork;
+
+static void *ParallelWorker(void *arg) {
+    ParallelWork *work = arg;
+    for (;;) {
+        size_t index = atomic_fetch_add_explicit(&work->next, 1, memory_order_relaxed);
+        if (index >= work->count) break;
+        work->function(work->data, index);
+    }
+    return NULL;
+}
+
+void ParallelFor(size_t count, size_t thread_count, ParallelFunction function, void *data) {
+    if (thread_count == 0) thread_count = (size_t)nob_nprocs();
+    if (thread_count > count) thread_count = count;
+    if (count == 0) return;
+
+    ParallelWork work = { function, data, count, 0 };
+    atomic_init(&work.next, 0);
+
+    // The calling thread is one of them; if threads cannot be started, fewer run it all the same
+    pthread_t *threads = NOB_REALLOC(NULL, thread_count * sizeof(*threads));
+    NOB_ASSERT(threads != NULL && "Buy more RAM lol");
+    size_t started = 0;
+    for (size_t i = 0; i + 1 < thread_count; i++) {
+        if (pthread_create(&threads[started], NULL, ParallelWorker, &work) != 0) break;
+        started++;
+    }
+    ParallelWorker(&work);
+    // Joining makes every write of the other threads visible to the caller
+    for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    NOB_FREE(threads);
+}
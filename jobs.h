@@ -0,0 +1,33 @@
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Runs on a worker thread. Must not touch the GPU, nor nob's temporary allocator, which is not thread-safe.
+typedef void (*JobFunction)(void *data);
+// Runs on the thread calling DrainJobs, once the job has run. This is where GPU resources get uploaded.
+typedef void (*JobCompletion)(void *data);
+
+typedef struct JobSystem JobSystem;
+
+// Body of a ParallelFor, called once per index
+typedef void (*ParallelFunction)(void *data, size_t index);
+
+// Starts `worker_count` worker threads, one less than the number of cores if 0.
+JobSystem *StartJobs(size_t worker_count);
+void SubmitJob(JobSystem *jobs, JobFunction run, JobCompletion complete, void *data);
+// Runs the completions of the jobs finished since the last call, in the order they finished.
+// Never blocks: finished jobs are handed over through a lock-free queue. Returns how many ran.
+size_t DrainJobs(JobSystem *jobs);
+// Jobs submitted whose completion has not run yet
+size_t PendingJobs(const JobSystem *jobs);
+// Lets the workers finish every submitted job, then runs the remaining completions and frees everything.
+void StopJobs(JobSystem *jobs);
+
+// Calls `function(data, i)` for every i in [0, count) on `thread_count` threads, the calling one
+// included (one per core if 0), and returns once every call returned. It starts threads of its own
+// rather than using a JobSystem, so it may be called from a job.
+void ParallelFor(size_t count, size_t thread_count, ParallelFunction function, void *data);
+
+#endif // JOBS_H_
@@ -7,86 +7,38 @@
 #include "raylib.h"
 #include "rlgl.h"
 #include "raymath.h"
-#include "cJSON/cJSON.h"
+#include "osm.h"
+#include "buildings.h"
+#include "buildingsmesh.h"
+#include "culling.h"
+#include "polylines.h"
+#include "profiler.h"
+#include "renderstats.h"
+#include "tiles.h"
+#include "jobs.h"
+#include "world.h"
 
 #define HEIGHT 600
 #define WIDTH 800
 
-#define MAP_LAT_MIN 48.868276
-#define MAP_LAT_MAX 48.876301
-#define MAP_LAT_MID ((MAP_LAT_MIN + MAP_LAT_MAX) * 0.5)
-#define MAP_LAT_HEIGHT (MAP_LAT_MAX - MAP_LAT_MIN)
-
-#define MAP_LON_MIN 2.768697
-#define MAP_LON_MAX 2.784665
-#define MAP_LON_MID ((MAP_LON_MIN + MAP_LON_MAX) * 0.5)
-#define MAP_LON_WIDTH (MAP_LON_MAX - MAP_LON_MIN)
-
-#define SCALE 0.01f // factor 1/100 to circumvent fixed frustrum limitation
-#define LAT_TO_METER (111319.9 * SCALE)
-#define LON_TO_METER (73324.94 * SCALE)
-
-Vector3 latlon_to_world(const Vector2 latlon, const float height) {
-    return (Vector3){
-        (latlon.x - MAP_LAT_MID) * LAT_TO_METER,
-        height * SCALE,
-        (latlon.y - MAP_LON_MID) * LON_TO_METER
-    };
-}
+#define CONTOUR_WIDTH 1.5f // in meters
 
-typedef struct {
-    const char *name;
-    const int year_from;
-    const int year_to;
-    const Vector2 latlon; // in degrees
-    const Vector2 size; // in meters
-    const float height; // in meters
-    const Color color;
-} Building;
-
-const Building buildings[] = {
-    { "Castle", 1992, -1, { 48.873183 , 2.776001 }, { 35, 25 }, 60, { 0xff, 0x00, 0x00, 0xff }},
-    { "Hotel", 1992, -1, { 48.87031 , 2.779653 }, { 270, 100 }, 30, { 0x00, 0x00, 0xff, 0xff }},
-    { "Space Mountain", 1995, 1998, { 48.874022 , 2.779266 }, { 75, 75 }, 32, { 0x00, 0xff, 0x00, 0xff }},
+const Color osm_kind_colors[OSM_KIND_COUNT] = {
+    [OSM_KIND_OTHER]    = RED,
+    [OSM_KIND_BUILDING] = ORANGE,
+    [OSM_KIND_PATH]     = LIGHTGRAY,
+    [OSM_KIND_WATER]    = SKYBLUE,
+    [OSM_KIND_RAIL]     = BROWN,
 };
-const size_t buildings_count = sizeof(buildings) / sizeof(buildings[0]);
-
-void DrawBuilding(const Building *building, const float z_offset) {
-    DrawCube(latlon_to_world(building->latlon, (0.5f * building->height + z_offset)),
-             building->size.x * SCALE, building->height * SCALE, building->size.y * SCALE,
-             building->color);
-}
 
-// From https://www.raylib.com/examples/models/loader.html?name=models_draw_cube_texture
-void DrawRectTexture(Texture2D texture, Vector3 position, float width, float length, Color color)
-{
-    float x = position.x;
-    float y = position.y;
-    float z = position.z;
-
-    // Set desired texture to be enabled while drawing following vertex data
-    rlSetTexture(texture.id);
-
-    // Vertex data transformation can be defined with the commented lines,
-    // but in this example we calculate the transformed vertex data directly when calling rlVertex3f()
-    //rlPushMatrix();
-        // NOTE: Transformation is applied in inverse order (scale -> rotate -> translate)
-        //rlTranslatef(2.0f, 0.0f, 0.0f);
-        //rlRotatef(45, 0, 1, 0);
-        //rlScalef(1.0f, 1.0f, 1.0f);
-
-        rlBegin(RL_QUADS);
-            rlColor4ub(color.r, color.g, color.b, color.a);
-            // Top Face
-            rlNormal3f(0.0f, 1.0f, 0.0f);       // Normal Pointing Up
-            rlTexCoord2f(0.0f, 1.0f); rlVertex3f(x - width/2, y, z - length/2);  // Top Left Of The Texture and Quad
-            rlTexCoord2f(1.0f, 1.0f); rlVertex3f(x - width/2, y, z + length/2);  // Bottom Left Of The Texture and Quad
-            rlTexCoord2f(1.0f, 0.0f); rlVertex3f(x + width/2, y, z + length/2);  // Bottom Right Of The Texture and Quad
-            rlTexCoord2f(0.0f, 0.0f); rlVertex3f(x + width/2, y, z - length/2);  // Top Right Of The Texture and Quad
-        rlEnd();
-    //rlPopMatrix();
-
-    rlSetTexture(0);
+void DrawBuilding(const Buildings *buildings, const size_t i, const float z_offset, const Frustum *frustum) {
+    if (!FrustumContainsBox(frustum, BuildingBounds(buildings, i, z_offset))) return;
+    Vector3 position = buildings->world[i];
+    position.y += (0.5f * buildings->height[i] + z_offset) * SCALE;
+    CountDraw(0, 36);
+    DrawCube(position,
+             buildings->size[i].x * SCALE, buildings->height[i] * SCALE, buildings->size[i].y * SCALE,
+             buildings->color[i]);
 }
 
 float lerp(const float t, const float a, const float b) {
@@ -180,124 +132,218 @@ Camera3D GetNewCamera() {
     return camera;
 }
 
+// The layers loaded in the background. A loading job fills the data and its `*_ok` flag on a worker,
+// its completion uploads the GPU side on the main thread and sets `*_ready`; a layer is only drawn once ready.
 typedef struct {
-    Vector2 *items;
-    size_t count;
-    size_t capacity;
-} Contour;
+    OsmGeometry contour;
+    bool contour_ok;
+    PolylineLayer contour_layer;
+    bool contour_ready;
+
+    Buildings buildings;
+    bool buildings_ok;
+    BuildingsMesh buildings_mesh;
+    bool buildings_ready;
+} Layers;
+
+void LoadContourJob(void *data) {
+    Layers *layers = data;
+    layers->contour_ok = LoadOsmGeometryCached("assets/buildings/contour.json", &layers->contour);
+    if (layers->contour_ok) layers->contour_layer = BuildPolylineLayer(&layers->contour, osm_kind_colors, CONTOUR_WIDTH);
+}
 
-typedef struct {
-    size_t *items;
-    size_t count;
-    size_t capacity;
-} NodeIds;
+void ContourLoaded(void *data) {
+    Layers *layers = data;
+    if (!layers->contour_ok) return;
+    UploadPolylineLayer(&layers->contour_layer);
+    layers->contour_ready = true;
+}
 
+void LoadBuildingsJob(void *data) {
+    Layers *layers = data;
+    layers->buildings_ok = LoadBuildings("assets/buildings/buildings.csv", &layers->buildings);
+}
 
+void BuildingsLoaded(void *data) {
+    Layers *layers = data;
+    if (!layers->buildings_ok) return;
+    layers->buildings_mesh = LoadBuildingsMesh(&layers->buildings);
+    layers->buildings_ready = true;
+}
 
-bool ParseContour(const char* filename, Contour* contour) {
-    bool result = false;
-    cJSON* json = NULL;
-    Nob_String_Builder sb = {0};
-    Contour temp_contour = {0};
-    NodeIds node_ids = {0};
+void DrawFrame(Layers *layers, TileMap *satellite, Camera3D camera, float current_year, int target_year) {
+    Buildings *buildings = &layers->buildings;
+    BuildingsMesh *buildings_mesh = &layers->buildings_mesh;
 
-    if (!nob_read_entire_file(filename, &sb)) {
-        nob_log(NOB_ERROR, "Could not read file %s", filename);
-        nob_return_defer(false);
-    }
+    BeginDrawing();
+    {
+    ClearBackground((Color){ 0x18, 0x18, 0x18, 0xff });
+    DrawText(TextFormat("Year: %d", target_year), 10, 10, 20, RAYWHITE);
 
-    json = cJSON_Parse(sb.items);
-    if (json == NULL) {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        nob_log(NOB_ERROR, "Could not parse JSON file %s: %.100s", filename, error_ptr);
-        nob_return_defer(false);
-    }
+    BeginMode3D(camera);
+    {
+    const Frustum frustum = GetViewFrustum();
+    PROFILE(PROFILE_MAP) DrawTileMap(satellite);
 
-    cJSON* elements = cJSON_GetObjectItemCaseSensitive(json, "elements");
-    if (elements == NULL || !cJSON_IsArray(elements)) {
-        nob_log(NOB_ERROR, "Could not find array 'elements' in JSON file %s", filename);
-        nob_return_defer(false);
+    if (layers->contour_ready) {
+        PROFILE(PROFILE_CONTOUR) DrawPolylineLayer(&layers->contour_layer, &frustum, camera);
     }
 
-    cJSON* nodes = NULL;
-    for (cJSON* element = elements->child; element != NULL; element = element->next)
-    {
-        cJSON* type = cJSON_GetObjectItemCaseSensitive(element, "type");
-        if (!cJSON_IsString(type)) {
-            continue;
+    if (layers->buildings_ready) {
+        // Buildings standing still all year are in the mesh, only those rising or falling are drawn one by one
+        PROFILE(PROFILE_TIMELINE) UpdateBuildingsMesh(buildings_mesh, buildings, current_year);
+        PROFILE(PROFILE_BUILDINGS) {
+        DrawBuildingsMesh(buildings_mesh, &frustum);
+
+        size_t visible_count = 0;
+        const size_t *visible = BuildingsAtYear(buildings, current_year, &visible_count);
+        for (size_t v = 0; v < visible_count; v++) {
+            const size_t i = visible[v];
+            if (BuildingStandsThroughYear(buildings, i, buildings_mesh->year)) continue;
+            const int year_from = buildings->year_from[i];
+            const int year_to = buildings->year_to[i];
+            if (current_year >= year_from && (current_year < year_to || year_to == -1))
+                DrawBuilding(buildings, i, 0.0f, &frustum);
+            else if (current_year > year_from - 1 && current_year < year_from)
+                DrawBuilding(buildings, i, map_range(current_year, year_from, year_from - 1, 0.0f, -1.0f / SCALE), &frustum);
+            else if (year_to > 0 && current_year < year_to + 1 && current_year >= year_to)
+                DrawBuilding(buildings, i, map_range(current_year, year_to, year_to + 1, 0.0f, 10.0f / SCALE), &frustum);
         }
-
-        if (strcmp(type->valuestring, "way") == 0) {
-            nodes = cJSON_GetObjectItemCaseSensitive(element, "nodes");
         }
-        else if (strcmp(type->valuestring, "node") == 0) {
-            cJSON* id = cJSON_GetObjectItemCaseSensitive(element, "id");
-            cJSON* lat = cJSON_GetObjectItemCaseSensitive(element, "lat");
-            cJSON* lon = cJSON_GetObjectItemCaseSensitive(element, "lon");
-            if (!cJSON_IsNumber(id) || !cJSON_IsNumber(lat) || !cJSON_IsNumber(lon)) {
-                nob_log(NOB_ERROR, "Could not find 'id', 'lat' or 'lon' in element of type 'node'");
-                continue;
-            }
+    }
+    }
+    EndMode3D();
 
-            nob_da_append(&node_ids, id->valueint);
-            nob_da_append(&temp_contour, ((Vector2){ .x = lat->valuedouble, .y = lon->valuedouble }));
-        }
+    if (profiler.visible) DrawProfiler(10, 40);
     }
+    PROFILE(PROFILE_PRESENT) EndDrawing();
+}
 
-    if (nodes == NULL || !cJSON_IsArray(nodes)) {
-        nob_log(NOB_ERROR, "Could not find element of type 'way' in JSON file %s", filename);
-        nob_return_defer(false);
+#define BENCH_DEFAULT_FRAMES 600
+#define BENCH_FIRST_YEAR 1992
+#define BENCH_LAST_YEAR 2025
+#define BENCH_MAX_ZOOM 8.0f     // zooms out this much halfway through
+#define BENCH_PAN_RADIUS 2.0f   // in world units
+
+// Camera at `t` in [0, 1] of the benchmark: one loop around the starting view, zooming out and back in
+Camera3D GetBenchCamera(float t) {
+    Camera3D camera = GetNewCamera();
+    Vector3 offset = Vector3Subtract(camera.position, camera.target);
+    float angle = 2.0f * PI * t;
+    float zoom = powf(BENCH_MAX_ZOOM, sinf(PI * t));
+    camera.target.x += BENCH_PAN_RADIUS * sinf(angle);
+    camera.target.z += BENCH_PAN_RADIUS * (1.0f - cosf(angle));
+    if (camera.projection == CAMERA_ORTHOGRAPHIC) camera.fovy *= zoom;
+    else offset = Vector3Scale(offset, zoom);
+    camera.position = Vector3Add(camera.target, offset);
+    return camera;
+}
+
+int CompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Renders `frame_count` frames along a scripted camera path and year sweep, as fast as possible,
+// and prints the distribution of the frame times. Loading is waited for and not timed, neither
+// at the start nor for the tiles each frame streams in, so runs are comparable.
+void RunBench(Layers *layers, TileMap *satellite, JobSystem *jobs, size_t frame_count) {
+    while (PendingJobs(jobs) > 0) {
+        DrainJobs(jobs);
+        WaitTime(0.001);
     }
 
-    for (cJSON* node = nodes->child; node != NULL; node = node->next)
-    {
-        if (!cJSON_IsNumber(node)) {
-            nob_log(NOB_ERROR, "'node' is not a number in 'way'");
-            continue;
+    double *frame_times = NOB_REALLOC(NULL, frame_count * sizeof(*frame_times));
+    NOB_ASSERT(frame_times != NULL && "Buy more RAM lol");
+    size_t total_draw_calls = 0, max_draw_calls = 0;
+    size_t total_vertices = 0, max_vertices = 0;
+    size_t total_texture_binds = 0, max_texture_binds = 0;
+    for (size_t frame = 0; frame < frame_count; frame++) {
+        const float t = frame_count > 1 ? (float)frame / (float)(frame_count - 1) : 0.0f;
+        const float current_year = Lerp(BENCH_FIRST_YEAR, BENCH_LAST_YEAR, t);
+        const Camera3D camera = GetBenchCamera(t);
+
+        double start = GetTime();
+        UpdateTileMap(satellite, camera);
+        double update_time = GetTime() - start;
+        while (PendingJobs(jobs) > 0) {
+            DrainJobs(jobs);
+            WaitTime(0.0005);
         }
 
-        size_t id = (size_t)node->valuedouble;
-        size_t index = SIZE_MAX;
-        for (size_t i = 0; i < node_ids.count; i++) {
-            if (node_ids.items[i] == id) {
-                index = i;
-                break;
-            }
-        }
-        if (index == SIZE_MAX) {
-            nob_log(NOB_ERROR, "Could not find node with id %zu", id);
-            continue;
-        }
+        start = GetTime();
+        DrawFrame(layers, satellite, camera, current_year, (int)floorf(current_year));
+        frame_times[frame] = update_time + GetTime() - start;
+
+        total_draw_calls += render_stats.draw_calls;
+        total_vertices += render_stats.vertices;
+        if (render_stats.draw_calls > max_draw_calls) max_draw_calls = render_stats.draw_calls;
+        if (render_stats.vertices > max_vertices) max_vertices = render_stats.vertices;
+        total_texture_binds += render_stats.texture_binds;
+        if (render_stats.texture_binds > max_texture_binds) max_texture_binds = render_stats.texture_binds;
+        EndProfileFrame();
+    }
 
-        nob_da_append(contour, temp_contour.items[index]);
+    qsort(frame_times, frame_count, sizeof(*frame_times), CompareDoubles);
+    double total = 0.0;
+    for (size_t frame = 0; frame < frame_count; frame++) total += frame_times[frame];
+    printf("Frame times over %zu frames at %dx%d (ms):\n", frame_count, GetScreenWidth(), GetScreenHeight());
+    printf("  mean %8.3f (%.0f fps)\n", total / frame_count * 1e3, frame_count / total);
+    const double percentiles[] = { 0.50, 0.90, 0.99, 1.00 };
+    for (size_t p = 0; p < NOB_ARRAY_LEN(percentiles); p++) {
+        size_t rank = (size_t)ceil(percentiles[p] * frame_count);
+        printf("  p%-3.0f %8.3f\n", percentiles[p] * 100.0, frame_times[rank > 0 ? rank - 1 : 0] * 1e3);
     }
-    result = true;
-
-defer:
-    if (json != NULL) cJSON_Delete(json);
-    nob_sb_free(sb);
-    nob_da_free(node_ids);
-    nob_da_free(temp_contour);
-    return result;
+    printf("Submitted per frame (mean, max):\n");
+    printf("  draw calls %10.1f %10zu\n", (double)total_draw_calls / frame_count, max_draw_calls);
+    printf("  vertices   %10.1f %10zu\n", (double)total_vertices / frame_count, max_vertices);
+    printf("  textures   %10.1f %10zu\n", (double)total_texture_binds / frame_count, max_texture_binds);
+    NOB_FREE(frame_times);
 }
 
-int main() {
-    Contour contour = {0};
-    if (!ParseContour("assets/buildings/contour.json", &contour)) {
-        return 1;
+// `--bench [frames]` renders a scripted sequence in a hidden window and reports the frame times,
+// instead of opening the interactive view. Set LIBGL_ALWAYS_SOFTWARE=1 to run it on Mesa's llvmpipe.
+int main(int argc, char **argv) {
+    bool bench = false;
+    size_t bench_frames = BENCH_DEFAULT_FRAMES;
+    nob_shift(argv, argc);
+    if (argc > 0 && strcmp(argv[0], "--bench") == 0) {
+        bench = true;
+        nob_shift(argv, argc);
+        if (argc > 0) {
+            char *end = NULL;
+            long frames = strtol(argv[0], &end, 10);
+            if (*end != '\0' || frames <= 0) {
+                nob_log(NOB_ERROR, "invalid number of frames %s", argv[0]);
+                return 1;
+            }
+            bench_frames = (size_t)frames;
+        }
     }
 
+    // Loading starts right away and the window opens without waiting for it
+    JobSystem *jobs = StartJobs(0);
+    Layers layers = {0};
+    SubmitJob(jobs, LoadContourJob, ContourLoaded, &layers);
+    SubmitJob(jobs, LoadBuildingsJob, BuildingsLoaded, &layers);
+
+    // Without a target FPS nor vsync, the benchmark's frames are not capped
+    if (bench) SetConfigFlags(FLAG_WINDOW_HIDDEN);
     InitWindow(WIDTH, HEIGHT, "Disneyland Paris over the years");
-    SetTargetFPS(60);
+    if (!bench) SetTargetFPS(60);
 
     Camera3D camera = GetNewCamera();
-    Texture dlp_satellite_texture = LoadTexture("assets/maps/dlp_satellite.png");
+    TileMap *satellite = LoadTileMap("assets/maps/dlp_satellite" TILE_DIRECTORY_EXTENSION, jobs);
 
     int target_year = 1992;
     float offset_year = 0.0f;
-    while (!WindowShouldClose()) {
+    if (bench) RunBench(&layers, satellite, jobs, bench_frames);
+    while (!bench && !WindowShouldClose()) {
+        PROFILE(PROFILE_INPUT) {
         UpdateCameraWithInputs(&camera);
 
+        if (IsKeyPressed(KEY_F3)) profiler.visible = !profiler.visible;
+
         if (IsKeyPressed(KEY_O) && target_year > 1992) {
             target_year--;
             offset_year = 1.0f;
@@ -321,39 +367,24 @@ int main() {
             offset_year += dy;
             if (offset_year > 0.0f) offset_year = 0.0f;
         }
+        }
         const float current_year = (float)target_year + offset_year;
 
-        BeginDrawing();
-        {
-        ClearBackground((Color){ 0x18, 0x18, 0x18, 0xff });
-        DrawText(TextFormat("Year: %d", target_year), 10, 10, 20, RAYWHITE);
-
-        BeginMode3D(camera);
-        {
-        Vector3 map_position = { 0 };
-        DrawRectTexture(dlp_satellite_texture,
-            map_position, MAP_LAT_HEIGHT * LAT_TO_METER, MAP_LON_WIDTH * LON_TO_METER,
-            WHITE);
-
-        for (size_t i = 0; i < contour.count; i++) {
-            DrawLine3D(latlon_to_world(contour.items[i], 0.0f),
-                        latlon_to_world(contour.items[(i + 1) % contour.count], 0.0f),
-                        RED);
+        PROFILE(PROFILE_STREAMING) {
+        DrainJobs(jobs);
+        UpdateTileMap(satellite, camera);
         }
 
-        for (size_t i = 0; i < buildings_count; i++) {
-            if (current_year >= buildings[i].year_from && (current_year < buildings[i].year_to || buildings[i].year_to == -1))
-                DrawBuilding(&buildings[i], 0.0f);
-            else if (current_year > buildings[i].year_from - 1 && current_year < buildings[i].year_from)
-                DrawBuilding(&buildings[i], map_range(current_year, buildings[i].year_from, buildings[i].year_from - 1, 0.0f, -1.0f / SCALE));
-            else if (buildings[i].year_to > 0 && current_year < buildings[i].year_to + 1 && current_year >= buildings[i].year_to)
-                DrawBuilding(&buildings[i], map_range(current_year, buildings[i].year_to, buildings[i].year_to + 1, 0.0f, 10.0f / SCALE));
-        }
-        }
-        EndMode3D();
-        }
-        EndDrawing();
+        DrawFrame(&layers, satellite, camera, current_year, target_year);
+        EndProfileFrame();
     }
+    // Finishes what is still loading, so nothing is freed under a worker
+    StopJobs(jobs);
+    UnloadTileMap(satellite);
+    if (layers.contour_ready) UnloadPolylineLayer(&layers.contour_layer);
+    if (layers.buildings_ready) UnloadBuildingsMesh(&layers.buildings_mesh);
     CloseWindow();
+    UnloadBuildings(&layers.buildings);
+    UnloadOsmGeometry(&layers.contour);
     return 0;
 }
\ No newline at end of file
@@ -1,16 +1,162 @@
 #define NOB_IMPLEMENTATION
 #include "nob.h"
 
+#define RAYLIB_INCLUDE "-I./raylib-5.5_macos/include"
+#define RAYLIB_LINK "-rpath", "@executable_path/raylib-5.5_macos/lib", "-L./raylib-5.5_macos/lib", "-lraylib"
+
+// Sources shared by the app and the benchmarks
+#define COMMON_SOURCES "osm.c", "osmcache.c", "buildings.c", "world.c", "idmap.c", "jobs.c", "cJSON/cJSON.c"
+// Everything the baked output depends on besides the asset itself
+#define BAKE_DEPENDENCIES "bake.c", COMMON_SOURCES, "osm.h", "world.h", "idmap.h", "jobs.h", "cJSON/cJSON.h", "nob.h"
+
+#define ASSETS_DIR "assets"
+// Must match OSM_CACHE_EXTENSION in osm.h, which nob cannot include without the raylib headers
+#define BAKED_EXTENSION ".bin"
+// Same for TILE_DIRECTORY_EXTENSION and TILE_INDEX_NAME in tiles.h
+#define TILES_EXTENSION ".tiles"
+#define TILES_INDEX_NAME "levels.txt"
+
+// Collects every file ending with `extension` below `dir`
+static bool collect_assets(const char *dir, const char *extension, Nob_File_Paths *assets)
+{
+    Nob_File_Paths children = {0};
+    if (!nob_read_entire_dir(dir, &children)) return false;
+    bool result = true;
+    for (size_t i = 0; i < children.count && result; ++i) {
+        const char *name = children.items[i];
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+        const char *path = nob_temp_sprintf("%s/%s", dir, name);
+        switch (nob_get_file_type(path)) {
+        case NOB_FILE_DIRECTORY:
+            result = collect_assets(path, extension, assets);
+            break;
+        case NOB_FILE_REGULAR:
+            if (nob_sv_end_with(nob_sv_from_cstr(name), extension)) nob_da_append(assets, path);
+            break;
+        default:
+            break;
+        }
+    }
+    nob_da_free(children);
+    return result;
+}
+
+// Runs `cmd` in the background, waiting for the running bakes first once there are as many as cores
+static bool bake_async(Nob_Cmd *cmd, Nob_Procs *procs)
+{
+    nob_da_append(procs, nob_cmd_run_async_and_reset(cmd));
+    if (procs->count >= (size_t)nob_nprocs()) return nob_procs_wait_and_reset(procs);
+    return true;
+}
+
+// Builds the bakers and runs them on every asset whose baked output is older than the asset or the baker,
+// up to nob_nprocs() at a time: bake for the *.json OSM responses, baketiles for the *.png maps
+static bool bake_assets(Nob_Cmd *cmd)
+{
+    const char *bake_dependencies[] = { BAKE_DEPENDENCIES };
+    int rebuild = nob_needs_rebuild("bake", bake_dependencies, NOB_ARRAY_LEN(bake_dependencies));
+    if (rebuild < 0) return false;
+    if (rebuild) {
+        nob_cmd_append(cmd, "cc", "-Wall", "-Wextra", "-O2");
+        nob_cmd_append(cmd, RAYLIB_INCLUDE);
+        nob_cmd_append(cmd, "-o", "bake");
+        nob_cmd_append(cmd, "bake.c", COMMON_SOURCES);
+        nob_cmd_append(cmd, "-lm", "-lpthread");
+        if (!nob_cmd_run_sync_and_reset(cmd)) return false;
+    }
+
+    Nob_File_Paths assets = {0};
+    Nob_File_Paths maps = {0};
+    Nob_Procs procs = {0};
+    bool result = true;
+    if (!collect_assets(ASSETS_DIR, ".json", &assets)) nob_return_defer(false);
+    if (!collect_assets(ASSETS_DIR, ".png", &maps)) nob_return_defer(false);
+
+    for (size_t i = 0; i < assets.count; ++i) {
+        const char *input_path = assets.items[i];
+        const char *output_path = nob_temp_sprintf("%s%s", input_path, BAKED_EXTENSION);
+        const char *inputs[] = { input_path, "bake" };
+        int needs_bake = nob_needs_rebuild(output_path, inputs, NOB_ARRAY_LEN(inputs));
+        if (needs_bake < 0) nob_return_defer(false);
+        if (!needs_bake) continue;
+
+        nob_cmd_append(cmd, "./bake", input_path, output_path);
+        if (!bake_async(cmd, &procs)) nob_return_defer(false);
+    }
+
+    // The tile baker needs raylib to decode and resize images, so it is only built when there are maps
+    if (maps.count > 0) {
+        const char *baketiles_dependencies[] = { "baketiles.c", "tiles.h", "nob.h" };
+        rebuild = nob_needs_rebuild("baketiles", baketiles_dependencies, NOB_ARRAY_LEN(baketiles_dependencies));
+        if (rebuild < 0) nob_return_defer(false);
+        if (rebuild) {
+            nob_cmd_append(cmd, "cc", "-Wall", "-Wextra", "-O2");
+            nob_cmd_append(cmd, RAYLIB_INCLUDE);
+            nob_cmd_append(cmd, "-o", "baketiles");
+            nob_cmd_append(cmd, "baketiles.c");
+            nob_cmd_append(cmd, RAYLIB_LINK);
+            if (!nob_cmd_run_sync_and_reset(cmd)) nob_return_defer(false);
+        }
+    }
+    for (size_t i = 0; i < maps.count; ++i) {
+        const char *input_path = maps.items[i];
+        Nob_String_View stem = nob_sv_from_cstr(input_path);
+        stem.count -= strlen(".png");
+        const char *output_dir = nob_temp_sprintf(SV_Fmt TILES_EXTENSION, SV_Arg(stem));
+        const char *inputs[] = { input_path, "baketiles" };
+        int needs_bake = nob_needs_rebuild(nob_temp_sprintf("%s/%s", output_dir, TILES_INDEX_NAME), inputs, NOB_ARRAY_LEN(inputs));
+        if (needs_bake < 0) nob_return_defer(false);
+        if (!needs_bake) continue;
+
+        nob_cmd_append(cmd, "./baketiles", input_path, output_dir);
+        if (!bake_async(cmd, &procs)) nob_return_defer(false);
+    }
+    if (!nob_procs_wait_and_reset(&procs)) nob_return_defer(false);
+
+defer:
+    nob_da_free(procs);
+    nob_da_free(maps);
+    nob_da_free(assets);
+    return result;
+}
+
+static bool build_bench(Nob_Cmd *cmd)
+{
+    nob_cmd_append(cmd, "cc", "-Wall", "-Wextra", "-O2");
+    nob_cmd_append(cmd, RAYLIB_INCLUDE);
+    nob_cmd_append(cmd, "-o", "bench");
+    nob_cmd_append(cmd, "bench.c", COMMON_SOURCES);
+    nob_cmd_append(cmd, "-lm", "-lpthread");
+    if (!nob_cmd_run_sync_and_reset(cmd)) return false;
+    nob_cmd_append(cmd, "./bench");
+    return nob_cmd_run_sync_and_reset(cmd);
+}
+
 int main(int argc, char **argv)
 {
     NOB_GO_REBUILD_URSELF(argc, argv);
+    nob_shift(argv, argc);
     Nob_Cmd cmd = {0};
+
+    // ./nob bench: build and run the loading benchmarks
+    if (argc > 0 && strcmp(argv[0], "bench") == 0) {
+        if (!build_bench(&cmd)) return 1;
+        return 0;
+    }
+
+    // ./nob bake: only bake the assets
+    if (argc > 0 && strcmp(argv[0], "bake") == 0) {
+        if (!bake_assets(&cmd)) return 1;
+        return 0;
+    }
+
+    if (!bake_assets(&cmd)) return 1;
+
     nob_cmd_append(&cmd, "cc", "-Wall", "-Wextra");
-    nob_cmd_append(&cmd, "-I./raylib-5.5_macos/include");
+    nob_cmd_append(&cmd, RAYLIB_INCLUDE);
     nob_cmd_append(&cmd, "-o", "main");
-    nob_cmd_append(&cmd, "main.c", "cJSON/cJSON.c");
-    nob_cmd_append(&cmd, "-rpath", "@executable_path/raylib-5.5_macos/lib");
-    nob_cmd_append(&cmd, "-L./raylib-5.5_macos/lib", "-lraylib");
+    nob_cmd_append(&cmd, "main.c", "buildingsmesh.c", "polylines.c", "tiles.c", "culling.c", "renderstats.c", "profiler.c", COMMON_SOURCES);
+    nob_cmd_append(&cmd, RAYLIB_LINK, "-lpthread");
     if (!nob_cmd_run_sync_and_reset(&cmd)) return 1;
     return 0;
-}
\ No newline at end of file
+}
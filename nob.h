@@ -193,6 +193,7 @@
 #    include <sys/stat.h>
 #    include <unistd.h>
 #    include <fcntl.h>
+#    include <sys/mman.h>
 #endif
 
 #ifdef _WIN32
@@ -340,6 +341,9 @@ typedef struct {
 bool nob_procs_wait(Nob_Procs procs);
 bool nob_procs_wait_and_reset(Nob_Procs *procs);
 
+// Number of logical processors online, at least 1
+int nob_nprocs(void);
+
 // Wait until the process has finished
 bool nob_proc_wait(Nob_Proc proc);
 
@@ -483,6 +487,11 @@ Nob_String_View nob_sv_from_parts(const char *data, size_t count);
 // nob_sb_to_sv() enables you to just view Nob_String_Builder as Nob_String_View
 #define nob_sb_to_sv(sb) nob_sv_from_parts((sb).items, (sb).count)
 
+// Maps the whole file read-only into memory, without copying it or allocating anything.
+// The view is not NUL-terminated and stays valid until nob_unmap_file().
+bool nob_map_file(const char *path, Nob_String_View *sv);
+void nob_unmap_file(Nob_String_View sv);
+
 // printf macros for String_View
 #ifndef SV_Fmt
 #define SV_Fmt "%.*s"
@@ -950,6 +959,18 @@ bool nob_procs_wait_and_reset(Nob_Procs *procs)
     return success;
 }
 
+int nob_nprocs(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif // _WIN32
+}
+
 bool nob_proc_wait(Nob_Proc proc)
 {
     if (proc == NOB_INVALID_PROC) return false;
@@ -1427,6 +1448,63 @@ defer:
     return result;
 }
 
+bool nob_map_file(const char *path, Nob_String_View *sv)
+{
+    *sv = nob_sv_from_parts("", 0);
+#ifdef _WIN32
+    bool result = true;
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE mapping = NULL;
+    if (file == INVALID_HANDLE_VALUE) nob_return_defer(false);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) nob_return_defer(false);
+    // Empty files cannot be mapped, the empty view is all there is to them
+    if (size.QuadPart == 0) nob_return_defer(true);
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) nob_return_defer(false);
+    const char *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) nob_return_defer(false);
+    *sv = nob_sv_from_parts(data, (size_t)size.QuadPart);
+
+defer:
+    if (!result) nob_log(NOB_ERROR, "Could not map file %s: %s", path, nob_win32_error_message(GetLastError()));
+    // The view keeps the mapping alive on its own
+    if (mapping != NULL) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    return result;
+#else
+    bool result = true;
+    struct stat statbuf;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)                     nob_return_defer(false);
+    if (fstat(fd, &statbuf) < 0)    nob_return_defer(false);
+    // Empty files cannot be mapped, the empty view is all there is to them
+    if (statbuf.st_size == 0)       nob_return_defer(true);
+
+    void *data = mmap(NULL, (size_t)statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)         nob_return_defer(false);
+    *sv = nob_sv_from_parts(data, (size_t)statbuf.st_size);
+
+defer:
+    if (!result) nob_log(NOB_ERROR, "Could not map file %s: %s", path, strerror(errno));
+    // The mapping stays valid after the descriptor is closed
+    if (fd >= 0) close(fd);
+    return result;
+#endif // _WIN32
+}
+
+void nob_unmap_file(Nob_String_View sv)
+{
+    if (sv.count == 0) return;
+#ifdef _WIN32
+    UnmapViewOfFile(sv.data);
+#else
+    munmap((void*)sv.data, sv.count);
+#endif // _WIN32
+}
+
 Nob_String_View nob_sv_chop_by_delim(Nob_String_View *sv, char delim)
 {
     size_t i = 0;
@@ -1700,6 +1778,8 @@ int closedir(DIR *dirp)
         #define da_append_many nob_da_append_many
         #define String_Builder Nob_String_Builder
         #define read_entire_file nob_read_entire_file
+        #define map_file nob_map_file
+        #define unmap_file nob_unmap_file
         #define sb_append_buf nob_sb_append_buf
         #define sb_append_cstr nob_sb_append_cstr
         #define sb_append_null nob_sb_append_null
@@ -1714,6 +1794,7 @@ int closedir(DIR *dirp)
         #define Procs Nob_Procs
         #define procs_wait nob_procs_wait
         #define procs_wait_and_reset nob_procs_wait_and_reset
+        #define nprocs nob_nprocs
         #define proc_wait nob_proc_wait
         #define Cmd Nob_Cmd
         #define Cmd_Redirect Nob_Cmd_Redirect
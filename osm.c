@@ -0,0 +1,916 @@
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+
+#include "nob.h"
+#include "cJSON/cJSON.h"
+#include "idmap.h"
+#include "jobs.h"
+#include "osm.h"
+#include "world.h"
+
+#define OSM_ALLOC_ARRAY(array, count)                                     \
+    do {                                                                  \
+        (array) = NOB_REALLOC(NULL, ((count) + 1) * sizeof(*(array)));    \
+        NOB_ASSERT((array) != NULL && "Buy more RAM lol");                \
+    } while (0)
+
+// Nesting depths of the interesting parts of an Overpass response:
+// { "elements": [ { "nodes": [..], "tags": {..}, "members": [ {..} ] } ] }
+#define OSM_DEPTH_ROOT     1
+#define OSM_DEPTH_ELEMENTS 2
+#define OSM_DEPTH_ELEMENT  3
+#define OSM_DEPTH_FIELD    4
+#define OSM_DEPTH_MEMBER   5
+
+typedef enum {
+    OSM_ELEMENT_UNKNOWN = 0,
+    OSM_ELEMENT_NODE,
+    OSM_ELEMENT_WAY,
+    OSM_ELEMENT_RELATION,
+} OsmElementType;
+
+typedef enum {
+    OSM_FIELD_NONE = 0,
+    OSM_FIELD_TYPE,
+    OSM_FIELD_ID,
+    OSM_FIELD_LAT,
+    OSM_FIELD_LON,
+    OSM_FIELD_NODES,
+    OSM_FIELD_TAGS,
+    OSM_FIELD_MEMBERS,
+    OSM_FIELD_REF,  // member fields
+    OSM_FIELD_ROLE,
+} OsmField;
+
+#define OSM_HAS(field) (1u << (field))
+
+typedef struct {
+    int64_t *items;
+    size_t count;
+    size_t capacity;
+} OsmIds;
+
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+} OsmOffsets;
+
+typedef struct {
+    Vector2 *items;
+    size_t count;
+    size_t capacity;
+} OsmNodes;
+
+// Sizes gathered by the first pass so that every array is allocated exactly once
+typedef struct {
+    size_t vertices;
+    size_t ways;
+    size_t relations;
+    size_t members;
+    size_t tags;
+    size_t strings_size;
+} OsmCounts;
+
+// The element being streamed. Its fields may come in any order, so they are collected
+// here and committed once its object ends. The arrays are reused across elements.
+typedef struct {
+    OsmElementType type;
+    unsigned fields; // OSM_HAS(OsmField) of the fields seen so far
+    int64_t id;
+    double lat;
+    double lon;
+    OsmIds refs;              // node ids of a way, way ids of a relation
+    OsmOffsets roles;         // role of each relation member, into strings
+    OsmOffsets tags;          // key/value pairs, into strings
+    Nob_String_Builder strings;
+
+    // member of a relation being streamed
+    unsigned member_fields;
+    OsmField member_field;
+    bool member_is_way;
+    int64_t member_ref;
+    size_t member_role;
+} OsmElement;
+
+// What pass 2 resolves references against, built once pass 1 has seen every element
+typedef struct {
+    OsmNodes nodes;
+    IdMap node_ids;    // node id -> index into nodes
+    IdMap way_ids;     // way id -> index of the way in the geometry
+} OsmIndex;
+
+typedef struct {
+    int pass; // 1: collect nodes and count, 2: fill ways and relations
+    size_t depth;
+    bool elements_key; // the last key of the root object was "elements"
+    bool in_elements;
+    bool found_elements;
+    OsmField field;    // field of the current element the parser is in
+    size_t tag_key;    // offset of the pending tag key in element.strings
+    OsmElement element;
+
+    // Pass 1 output, in the order of the elements
+    OsmCounts counts;
+    OsmNodes nodes;
+    OsmIds node_ids;
+    OsmIds way_ids;
+
+    // Pass 2
+    const OsmIndex *index;
+    OsmGeometry *geometry;
+} OsmLoader;
+
+static size_t OsmPushString(OsmGeometry *geometry, const char *string) {
+    size_t offset = geometry->strings_size;
+    size_t size = strlen(string) + 1;
+    memcpy(geometry->strings + offset, string, size);
+    geometry->strings_size += size;
+    return offset;
+}
+
+static void OsmPushTags(OsmGeometry *geometry, const OsmElement *element, size_t *offset, size_t *count) {
+    *offset = geometry->tag_count;
+    for (size_t i = 0; i + 1 < element->tags.count; i += 2) {
+        geometry->tag_keys[geometry->tag_count] = OsmPushString(geometry, element->strings.items + element->tags.items[i]);
+        geometry->tag_values[geometry->tag_count] = OsmPushString(geometry, element->strings.items + element->tags.items[i + 1]);
+        geometry->tag_count++;
+    }
+    *count = geometry->tag_count - *offset;
+}
+
+static const char *OsmFindTag(const OsmGeometry *geometry, size_t offset, size_t count, const char *key) {
+    for (size_t i = offset; i < offset + count; i++) {
+        if (strcmp(geometry->strings + geometry->tag_keys[i], key) == 0) {
+            return geometry->strings + geometry->tag_values[i];
+        }
+    }
+    return NULL;
+}
+
+static OsmKind OsmClassify(const OsmGeometry *geometry, size_t tag_offset, size_t tag_count) {
+    const char *natural = OsmFindTag(geometry, tag_offset, tag_count, "natural");
+    if (OsmFindTag(geometry, tag_offset, tag_count, "building") != NULL ||
+        OsmFindTag(geometry, tag_offset, tag_count, "building:part") != NULL) return OSM_KIND_BUILDING;
+    if (OsmFindTag(geometry, tag_offset, tag_count, "highway") != NULL) return OSM_KIND_PATH;
+    if (OsmFindTag(geometry, tag_offset, tag_count, "railway") != NULL) return OSM_KIND_RAIL;
+    if ((natural != NULL && strcmp(natural, "water") == 0) ||
+        OsmFindTag(geometry, tag_offset, tag_count, "water") != NULL ||
+        OsmFindTag(geometry, tag_offset, tag_count, "waterway") != NULL) return OSM_KIND_WATER;
+    return OSM_KIND_OTHER;
+}
+
+static void OsmAllocate(OsmGeometry *geometry, const OsmCounts *counts) {
+    OSM_ALLOC_ARRAY(geometry->vertices, counts->vertices);
+    OSM_ALLOC_ARRAY(geometry->world_vertices, counts->vertices);
+    OSM_ALLOC_ARRAY(geometry->vertex_importance, counts->vertices);
+
+    OSM_ALLOC_ARRAY(geometry->way_ids, counts->ways);
+    OSM_ALLOC_ARRAY(geometry->way_offsets, counts->ways);
+    OSM_ALLOC_ARRAY(geometry->way_counts, counts->ways);
+    OSM_ALLOC_ARRAY(geometry->way_kinds, counts->ways);
+    OSM_ALLOC_ARRAY(geometry->way_tag_offsets, counts->ways);
+    OSM_ALLOC_ARRAY(geometry->way_tag_counts, counts->ways);
+
+    OSM_ALLOC_ARRAY(geometry->relation_ids, counts->relations);
+    OSM_ALLOC_ARRAY(geometry->relation_member_offsets, counts->relations);
+    OSM_ALLOC_ARRAY(geometry->relation_member_counts, counts->relations);
+    OSM_ALLOC_ARRAY(geometry->relation_kinds, counts->relations);
+    OSM_ALLOC_ARRAY(geometry->relation_tag_offsets, counts->relations);
+    OSM_ALLOC_ARRAY(geometry->relation_tag_counts, counts->relations);
+
+    OSM_ALLOC_ARRAY(geometry->member_ways, counts->members);
+    OSM_ALLOC_ARRAY(geometry->member_roles, counts->members);
+
+    OSM_ALLOC_ARRAY(geometry->tag_keys, counts->tags);
+    OSM_ALLOC_ARRAY(geometry->tag_values, counts->tags);
+
+    OSM_ALLOC_ARRAY(geometry->strings, counts->strings_size);
+}
+
+static size_t OsmElementPushString(OsmElement *element, const char *string, size_t length) {
+    size_t offset = element->strings.count;
+    if (length > 0) nob_sb_append_buf(&element->strings, string, length);
+    nob_sb_append_null(&element->strings);
+    return offset;
+}
+
+// Pass 1: nodes go straight into the node arrays, ways and relations are only counted
+static void OsmCommitPass1(OsmLoader *loader) {
+    OsmElement *element = &loader->element;
+    OsmCounts *counts = &loader->counts;
+
+    switch (element->type) {
+    case OSM_ELEMENT_NODE: {
+        unsigned required = OSM_HAS(OSM_FIELD_ID) | OSM_HAS(OSM_FIELD_LAT) | OSM_HAS(OSM_FIELD_LON);
+        if ((element->fields & required) != required) {
+            nob_log(NOB_ERROR, "Could not find 'id', 'lat' or 'lon' in element of type 'node'");
+            return;
+        }
+        nob_da_append(&loader->node_ids, element->id);
+        nob_da_append(&loader->nodes, ((Vector2){ .x = element->lat, .y = element->lon }));
+    } break;
+
+    case OSM_ELEMENT_WAY:
+        nob_da_append(&loader->way_ids, element->id);
+        counts->ways++;
+        counts->vertices += element->refs.count;
+        counts->tags += element->tags.count / 2;
+        counts->strings_size += element->strings.count;
+        break;
+
+    case OSM_ELEMENT_RELATION:
+        counts->relations++;
+        counts->members += element->refs.count;
+        counts->tags += element->tags.count / 2;
+        counts->strings_size += element->strings.count;
+        break;
+
+    case OSM_ELEMENT_UNKNOWN:
+        break;
+    }
+}
+
+static void OsmCommitWay(OsmLoader *loader) {
+    OsmGeometry *geometry = loader->geometry;
+    const OsmElement *element = &loader->element;
+    size_t way = geometry->way_count++;
+
+    geometry->way_ids[way] = element->id;
+    geometry->way_offsets[way] = geometry->vertex_count;
+    for (size_t i = 0; i < element->refs.count; i++) {
+        size_t index = 0;
+        if (!IdMapGet(&loader->index->node_ids, element->refs.items[i], &index)) {
+            nob_log(NOB_ERROR, "Could not find node with id %lld in way %lld",
+                    (long long)element->refs.items[i], (long long)element->id);
+            continue;
+        }
+        geometry->vertices[geometry->vertex_count++] = loader->index->nodes.items[index];
+    }
+    geometry->way_counts[way] = geometry->vertex_count - geometry->way_offsets[way];
+
+    OsmPushTags(geometry, element, &geometry->way_tag_offsets[way], &geometry->way_tag_counts[way]);
+    geometry->way_kinds[way] = OsmClassify(geometry, geometry->way_tag_offsets[way], geometry->way_tag_counts[way]);
+}
+
+static void OsmCommitRelation(OsmLoader *loader) {
+    OsmGeometry *geometry = loader->geometry;
+    const OsmElement *element = &loader->element;
+    size_t relation = geometry->relation_count++;
+
+    geometry->relation_ids[relation] = element->id;
+    geometry->relation_member_offsets[relation] = geometry->member_count;
+    for (size_t i = 0; i < element->refs.count; i++) {
+        size_t way = 0;
+        // Overpass only returns the ways it was asked for, so missing members are expected
+        if (!IdMapGet(&loader->index->way_ids, element->refs.items[i], &way)) continue;
+
+        geometry->member_ways[geometry->member_count] = way;
+        geometry->member_roles[geometry->member_count] = OsmPushString(geometry, element->strings.items + element->roles.items[i]);
+        geometry->member_count++;
+    }
+    geometry->relation_member_counts[relation] = geometry->member_count - geometry->relation_member_offsets[relation];
+
+    OsmPushTags(geometry, element, &geometry->relation_tag_offsets[relation], &geometry->relation_tag_counts[relation]);
+    geometry->relation_kinds[relation] = OsmClassify(geometry, geometry->relation_tag_offsets[relation], geometry->relation_tag_counts[relation]);
+}
+
+static cJSON_bool OsmOnStartObject(void *user_data) {
+    OsmLoader *loader = user_data;
+    OsmElement *element = &loader->element;
+
+    loader->depth++;
+    if (!loader->in_elements) return true;
+
+    if (loader->depth == OSM_DEPTH_ELEMENT) {
+        element->type = OSM_ELEMENT_UNKNOWN;
+        element->fields = 0;
+        element->refs.count = 0;
+        element->roles.count = 0;
+        element->tags.count = 0;
+        element->strings.count = 0;
+        loader->field = OSM_FIELD_NONE;
+    }
+    else if (loader->depth == OSM_DEPTH_MEMBER && loader->field == OSM_FIELD_MEMBERS) {
+        element->member_fields = 0;
+        element->member_field = OSM_FIELD_NONE;
+        element->member_is_way = false;
+    }
+    return true;
+}
+
+static cJSON_bool OsmOnEndObject(void *user_data) {
+    OsmLoader *loader = user_data;
+    OsmElement *element = &loader->element;
+
+    if (loader->in_elements && loader->depth == OSM_DEPTH_ELEMENT) {
+        if (loader->pass == 1) {
+            OsmCommitPass1(loader);
+        }
+        else if (element->type == OSM_ELEMENT_WAY) {
+            OsmCommitWay(loader);
+        }
+        else if (element->type == OSM_ELEMENT_RELATION) {
+            OsmCommitRelation(loader);
+        }
+        loader->field = OSM_FIELD_NONE;
+    }
+    else if (loader->in_elements && loader->depth == OSM_DEPTH_MEMBER && loader->field == OSM_FIELD_MEMBERS) {
+        if (element->member_is_way && (element->member_fields & OSM_HAS(OSM_FIELD_REF))) {
+            nob_da_append(&element->refs, element->member_ref);
+            nob_da_append(&element->roles, (element->member_fields & OSM_HAS(OSM_FIELD_ROLE))
+                                           ? element->member_role
+                                           : OsmElementPushString(element, "", 0));
+        }
+    }
+    loader->depth--;
+    return true;
+}
+
+static cJSON_bool OsmOnStartArray(void *user_data) {
+    OsmLoader *loader = user_data;
+    loader->depth++;
+    if (loader->depth == OSM_DEPTH_ELEMENTS && loader->elements_key) {
+        loader->in_elements = true;
+        loader->found_elements = true;
+    }
+    return true;
+}
+
+static cJSON_bool OsmOnEndArray(void *user_data) {
+    OsmLoader *loader = user_data;
+    if (loader->depth == OSM_DEPTH_ELEMENTS) loader->in_elements = false;
+    loader->depth--;
+    return true;
+}
+
+static cJSON_bool OsmOnKey(void *user_data, const char *key, size_t length) {
+    OsmLoader *loader = user_data;
+    OsmElement *element = &loader->element;
+
+    if (loader->depth == OSM_DEPTH_ROOT) {
+        loader->elements_key = strcmp(key, "elements") == 0;
+        return true;
+    }
+    if (!loader->in_elements) return true;
+
+    if (loader->depth == OSM_DEPTH_ELEMENT) {
+        if      (strcmp(key, "type") == 0)    loader->field = OSM_FIELD_TYPE;
+        else if (strcmp(key, "id") == 0)      loader->field = OSM_FIELD_ID;
+        else if (strcmp(key, "lat") == 0)     loader->field = OSM_FIELD_LAT;
+        else if (strcmp(key, "lon") == 0)     loader->field = OSM_FIELD_LON;
+        else if (strcmp(key, "nodes") == 0)   loader->field = OSM_FIELD_NODES;
+        else if (strcmp(key, "tags") == 0)    loader->field = OSM_FIELD_TAGS;
+        else if (strcmp(key, "members") == 0) loader->field = OSM_FIELD_MEMBERS;
+        else                                  loader->field = OSM_FIELD_NONE;
+    }
+    else if (loader->depth == OSM_DEPTH_FIELD && loader->field == OSM_FIELD_TAGS) {
+        loader->tag_key = OsmElementPushString(element, key, length);
+    }
+    else if (loader->depth == OSM_DEPTH_MEMBER && loader->field == OSM_FIELD_MEMBERS) {
+        if      (strcmp(key, "type") == 0) element->member_field = OSM_FIELD_TYPE;
+        else if (strcmp(key, "ref") == 0)  element->member_field = OSM_FIELD_REF;
+        else if (strcmp(key, "role") == 0) element->member_field = OSM_FIELD_ROLE;
+        else                               element->member_field = OSM_FIELD_NONE;
+    }
+    return true;
+}
+
+static cJSON_bool OsmOnString(void *user_data, const char *string, size_t length) {
+    OsmLoader *loader = user_data;
+    OsmElement *element = &loader->element;
+
+    if (!loader->in_elements) return true;
+
+    if (loader->depth == OSM_DEPTH_ELEMENT && loader->field == OSM_FIELD_TYPE) {
+        if      (strcmp(string, "node") == 0)     element->type = OSM_ELEMENT_NODE;
+        else if (strcmp(string, "way") == 0)      element->type = OSM_ELEMENT_WAY;
+        else if (strcmp(string, "relation") == 0) element->type = OSM_ELEMENT_RELATION;
+        element->fields |= OSM_HAS(OSM_FIELD_TYPE);
+    }
+    else if (loader->depth == OSM_DEPTH_FIELD && loader->field == OSM_FIELD_TAGS) {
+        nob_da_append(&element->tags, loader->tag_key);
+        nob_da_append(&element->tags, OsmElementPushString(element, string, length));
+    }
+    else if (loader->depth == OSM_DEPTH_MEMBER && loader->field == OSM_FIELD_MEMBERS) {
+        if (element->member_field == OSM_FIELD_TYPE) {
+            element->member_is_way = strcmp(string, "way") == 0;
+        }
+        else if (element->member_field == OSM_FIELD_ROLE) {
+            element->member_role = OsmElementPushString(element, string, length);
+            element->member_fields |= OSM_HAS(OSM_FIELD_ROLE);
+        }
+    }
+    return true;
+}
+
+static cJSON_bool OsmOnNumber(void *user_data, double valuedouble, long long valueint) {
+    OsmLoader *loader = user_data;
+    OsmElement *element = &loader->element;
+
+    if (!loader->in_elements) return true;
+
+    if (loader->depth == OSM_DEPTH_ELEMENT) {
+        switch (loader->field) {
+        case OSM_FIELD_ID:  element->id = (int64_t)valueint; break;
+        case OSM_FIELD_LAT: element->lat = valuedouble; break;
+        case OSM_FIELD_LON: element->lon = valuedouble; break;
+        default: return true;
+        }
+        element->fields |= OSM_HAS(loader->field);
+    }
+    else if (loader->depth == OSM_DEPTH_FIELD && loader->field == OSM_FIELD_NODES) {
+        nob_da_append(&element->refs, (int64_t)valueint);
+    }
+    else if (loader->depth == OSM_DEPTH_MEMBER && loader->field == OSM_FIELD_MEMBERS &&
+             element->member_field == OSM_FIELD_REF) {
+        element->member_ref = (int64_t)valueint;
+        element->member_fields |= OSM_HAS(OSM_FIELD_REF);
+    }
+    return true;
+}
+
+static const cJSON_StreamCallbacks osm_stream_callbacks = {
+    .start_object = OsmOnStartObject,
+    .end_object = OsmOnEndObject,
+    .start_array = OsmOnStartArray,
+    .end_array = OsmOnEndArray,
+    .key = OsmOnKey,
+    .string = OsmOnString,
+    .number = OsmOnNumber,
+};
+
+static bool OsmStream(OsmLoader *loader, const char *filename, const char *data, size_t size) {
+    loader->depth = 0;
+    loader->elements_key = false;
+    loader->in_elements = false;
+    loader->found_elements = false;
+
+    if (!cJSON_ParseStream(data, size, &osm_stream_callbacks, loader)) {
+        const char *error_ptr = cJSON_GetErrorPtr();
+        int context = (int)(data + size - error_ptr);
+        nob_log(NOB_ERROR, "Could not parse JSON file %s: %.*s", filename, context < 100 ? context : 100, error_ptr);
+        return false;
+    }
+    if (!loader->found_elements) {
+        nob_log(NOB_ERROR, "Could not find array 'elements' in JSON file %s", filename);
+        return false;
+    }
+    return true;
+}
+
+// Adds the nodes and ways pass 1 found in `loader`, the first way being way `way_base` of the geometry
+static void OsmIndexAdd(OsmIndex *index, const OsmLoader *loader, size_t way_base) {
+    for (size_t i = 0; i < loader->node_ids.count; i++) {
+        IdMapPut(&index->node_ids, loader->node_ids.items[i], index->nodes.count + i);
+    }
+    if (loader->nodes.count > 0) nob_da_append_many(&index->nodes, loader->nodes.items, loader->nodes.count);
+    for (size_t i = 0; i < loader->way_ids.count; i++) {
+        IdMapPut(&index->way_ids, loader->way_ids.items[i], way_base + i);
+    }
+}
+
+static void OsmIndexFree(OsmIndex *index) {
+    nob_da_free(index->nodes);
+    IdMapFree(&index->node_ids);
+    IdMapFree(&index->way_ids);
+}
+
+static void OsmLoaderFree(OsmLoader *loader) {
+    nob_da_free(loader->nodes);
+    nob_da_free(loader->node_ids);
+    nob_da_free(loader->way_ids);
+    nob_da_free(loader->element.refs);
+    nob_da_free(loader->element.roles);
+    nob_da_free(loader->element.tags);
+    nob_sb_free(loader->element.strings);
+}
+
+static float OsmDistanceToSegment(Vector3 p, Vector3 a, Vector3 b) {
+    Vector3 ab = { b.x - a.x, b.y - a.y, b.z - a.z };
+    Vector3 ap = { p.x - a.x, p.y - a.y, p.z - a.z };
+    float length_sqr = ab.x*ab.x + ab.y*ab.y + ab.z*ab.z;
+    // Closed ways start and end on the same node
+    float t = length_sqr == 0.0f ? 0.0f : (ap.x*ab.x + ap.y*ab.y + ap.z*ab.z) / length_sqr;
+    t = fminf(fmaxf(t, 0.0f), 1.0f);
+    Vector3 d = { ap.x - t*ab.x, ap.y - t*ab.y, ap.z - t*ab.z };
+    return sqrtf(d.x*d.x + d.y*d.y + d.z*d.z);
+}
+
+typedef struct {
+    size_t first;
+    size_t last;
+    float limit;    // importance of the vertex that split the parent range
+} OsmSimplifyRange;
+
+// Douglas-Peucker for every tolerance at once: the importance of a vertex is the largest tolerance it survives
+// the simplification at, so simplifying at a tolerance keeps the vertices more important than it.
+// A vertex is never more important than the one whose split made it a candidate, which is what
+// the recursion of Douglas-Peucker at a single tolerance would have checked first.
+// Ranks the vertices of the ways [first_way, first_way + way_count) from their world_vertices.
+static void OsmComputeImportance(OsmGeometry *geometry, size_t first_way, size_t way_count) {
+    size_t max_count = 0;
+    for (size_t way = first_way; way < first_way + way_count; way++) {
+        if (geometry->way_counts[way] > max_count) max_count = geometry->way_counts[way];
+    }
+    if (max_count == 0) return;
+
+    OsmSimplifyRange *ranges = NULL;
+    OSM_ALLOC_ARRAY(ranges, max_count);
+    for (size_t way = first_way; way < first_way + way_count; way++) {
+        const Vector3 *vertices = &geometry->world_vertices[geometry->way_offsets[way]];
+        float *importance = &geometry->vertex_importance[geometry->way_offsets[way]];
+        size_t count = geometry->way_counts[way];
+        if (count == 0) continue;
+
+        for (size_t i = 0; i < count; i++) importance[i] = 0.0f;
+        importance[0] = INFINITY;
+        importance[count - 1] = INFINITY;
+
+        size_t range_count = 0;
+        ranges[range_count++] = (OsmSimplifyRange){ 0, count - 1, INFINITY };
+        while (range_count > 0) {
+            OsmSimplifyRange range = ranges[--range_count];
+            if (range.last - range.first < 2) continue;
+
+            size_t farthest = range.first + 1;
+            float distance = -1.0f;
+            for (size_t i = range.first + 1; i < range.last; i++) {
+                float d = OsmDistanceToSegment(vertices[i], vertices[range.first], vertices[range.last]);
+                if (d > distance) {
+                    distance = d;
+                    farthest = i;
+                }
+            }
+
+            float limit = fminf(distance, range.limit);
+            importance[farthest] = limit;
+            ranges[range_count++] = (OsmSimplifyRange){ range.first, farthest, limit };
+            ranges[range_count++] = (OsmSimplifyRange){ farthest, range.last, limit };
+        }
+    }
+    NOB_FREE(ranges);
+}
+
+static bool OsmLoadSequential(const char *filename, Nob_String_View json, OsmGeometry *geometry) {
+    bool result = false;
+    OsmLoader loader = { .geometry = geometry };
+    OsmIndex index = {0};
+
+    // No tree is built: pass 1 streams the nodes into their arrays and sizes everything else,
+    // pass 2 fills the ways and relations, which may reference nodes that come after them.
+    loader.pass = 1;
+    if (!OsmStream(&loader, filename, json.data, json.count)) nob_return_defer(false);
+
+    IdMapReserve(&index.node_ids, loader.node_ids.count);
+    IdMapReserve(&index.way_ids, loader.way_ids.count);
+    OsmIndexAdd(&index, &loader, 0);
+    OsmAllocate(geometry, &loader.counts);
+
+    loader.pass = 2;
+    loader.index = &index;
+    if (!OsmStream(&loader, filename, json.data, json.count)) nob_return_defer(false);
+
+    // Projected and ranked once here (or once at bake time), so nothing does it per frame or per load of the cache
+    ProjectLatLonToWorld(geometry->vertices, geometry->vertex_count, 0.0f, geometry->world_vertices);
+    OsmComputeImportance(geometry, 0, geometry->way_count);
+    result = true;
+
+defer:
+    OsmLoaderFree(&loader);
+    OsmIndexFree(&index);
+    return result;
+}
+
+#define OSM_CHUNKS_PER_THREAD 4 // chunks differ in cost, so threads done early take more
+
+// Part of the elements array, parsed on its own by both passes
+typedef struct {
+    const char *data;       // elements separated by commas, without the brackets
+    size_t size;
+    OsmLoader loader;
+    OsmGeometry geometry;   // pass 2 output for the elements of the chunk
+    bool ok;
+    const char *error;      // where parsing stopped when not ok
+
+    // Where the chunk goes in the merged geometry
+    size_t vertex_base;
+    size_t way_base;
+    size_t relation_base;
+    size_t member_base;
+    size_t tag_base;
+    size_t string_base;
+} OsmChunk;
+
+typedef struct {
+    OsmChunk *items;
+    size_t count;
+    size_t capacity;
+    OsmIndex index;
+    OsmGeometry *geometry;
+} OsmChunks;
+
+// Structural pre-scan: finds the "elements" array of the root object and cuts it at the commas
+// between elements into at most `max_chunks` chunks of similar size. Strings are skipped along
+// with their escapes so nothing inside them counts. Only the elements get validated, by the chunks
+// parsing them: the rest of the root object is just scanned through.
+static bool OsmSplitElements(const char *filename, const char *data, size_t size, size_t max_chunks, OsmChunks *chunks) {
+    bool result = false;
+    size_t depth = 0;
+    const char *key = NULL;        // last string of the root object
+    size_t key_length = 0;
+    bool elements_value = false;   // after `"elements":`
+    const char *chunk_start = NULL;
+    size_t chunk_size = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        if (c == '"') {
+            size_t start = ++i;
+            while (i < size && data[i] != '"') i += data[i] == '\\' ? 2 : 1;
+            if (i >= size) nob_return_defer(false);
+            if (depth == 1) {
+                key = data + start;
+                key_length = i - start;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case ':':
+            if (depth == 1) elements_value = key_length == strlen("elements") && memcmp(key, "elements", key_length) == 0;
+            break;
+        case '{':
+        case '[':
+            depth++;
+            if (depth == 2 && c == '[' && elements_value) {
+                chunk_start = data + i + 1;
+                chunk_size = (size - i) / max_chunks;
+            }
+            elements_value = false;
+            break;
+        case ',':
+            // Inside the elements array, the only thing at depth 2 once it was found
+            if (depth == 2 && chunk_start != NULL && (size_t)(data + i - chunk_start) >= chunk_size && chunks->count + 1 < max_chunks) {
+                nob_da_append(chunks, ((OsmChunk){ .data = chunk_start, .size = (size_t)(data + i - chunk_start) }));
+                chunk_start = data + i + 1;
+            }
+            break;
+        case '}':
+        case ']':
+            if (depth == 0) nob_return_defer(false);
+            if (depth == 2 && c == ']' && chunk_start != NULL) {
+                nob_da_append(chunks, ((OsmChunk){ .data = chunk_start, .size = (size_t)(data + i - chunk_start) }));
+                nob_return_defer(true);
+            }
+            depth--;
+            break;
+        default:
+            break;
+        }
+    }
+
+defer:
+    if (result) return true;
+    if (chunk_start != NULL) nob_log(NOB_ERROR, "Could not parse JSON file %s: unterminated array 'elements'", filename);
+    else nob_log(NOB_ERROR, "Could not find array 'elements' in JSON file %s", filename);
+    return false;
+}
+
+// Streams the elements of the chunk one after the other, the loader starting inside the elements array
+static void OsmParseChunk(OsmChunk *chunk) {
+    OsmLoader *loader = &chunk->loader;
+    loader->depth = OSM_DEPTH_ELEMENTS;
+    loader->elements_key = false;
+    loader->in_elements = true;
+    loader->found_elements = true;
+
+    const char *end = chunk->data + chunk->size;
+    const char *p = chunk->data;
+    chunk->ok = false;
+    for (;;) {
+        while (p < end && isspace((unsigned char)*p)) p++;
+        if (p == end) break;
+        if (!cJSON_ParseStreamOpts(p, (size_t)(end - p), &osm_stream_callbacks, loader, &p)) {
+            chunk->error = p;
+            return;
+        }
+        while (p < end && isspace((unsigned char)*p)) p++;
+        if (p == end) break;
+        if (*p != ',') {
+            chunk->error = p;
+            return;
+        }
+        p++;
+    }
+    chunk->ok = true;
+}
+
+static void OsmParseChunkPass1(void *data, size_t index) {
+    OsmChunks *chunks = data;
+    OsmChunk *chunk = &chunks->items[index];
+    chunk->loader.pass = 1;
+    OsmParseChunk(chunk);
+}
+
+static void OsmParseChunkPass2(void *data, size_t index) {
+    OsmChunks *chunks = data;
+    OsmChunk *chunk = &chunks->items[index];
+    OsmAllocate(&chunk->geometry, &chunk->loader.counts);
+    chunk->loader.pass = 2;
+    chunk->loader.index = &chunks->index;
+    chunk->loader.geometry = &chunk->geometry;
+    OsmParseChunk(chunk);
+}
+
+#define OSM_COPY_ARRAY(chunk, geometry, array, base, count) \
+    memcpy((geometry)->array + (base), (chunk)->geometry.array, (count) * sizeof(*(geometry)->array))
+
+// Copies the chunk at its place in the merged geometry, rebasing what points into other arrays
+static void OsmMergeChunk(void *data, size_t index) {
+    OsmChunks *chunks = data;
+    const OsmChunk *chunk = &chunks->items[index];
+    const OsmGeometry *from = &chunk->geometry;
+    OsmGeometry *geometry = chunks->geometry;
+
+    OSM_COPY_ARRAY(chunk, geometry, vertices, chunk->vertex_base, from->vertex_count);
+    ProjectLatLonToWorld(from->vertices, from->vertex_count, 0.0f, geometry->world_vertices + chunk->vertex_base);
+
+    OSM_COPY_ARRAY(chunk, geometry, way_ids, chunk->way_base, from->way_count);
+    OSM_COPY_ARRAY(chunk, geometry, way_counts, chunk->way_base, from->way_count);
+    OSM_COPY_ARRAY(chunk, geometry, way_kinds, chunk->way_base, from->way_count);
+    OSM_COPY_ARRAY(chunk, geometry, way_tag_counts, chunk->way_base, from->way_count);
+    for (size_t i = 0; i < from->way_count; i++) {
+        geometry->way_offsets[chunk->way_base + i] = from->way_offsets[i] + chunk->vertex_base;
+        geometry->way_tag_offsets[chunk->way_base + i] = from->way_tag_offsets[i] + chunk->tag_base;
+    }
+    // A way's vertices all belong to its chunk
+    OsmComputeImportance(geometry, chunk->way_base, from->way_count);
+
+    OSM_COPY_ARRAY(chunk, geometry, relation_ids, chunk->relation_base, from->relation_count);
+    OSM_COPY_ARRAY(chunk, geometry, relation_member_counts, chunk->relation_base, from->relation_count);
+    OSM_COPY_ARRAY(chunk, geometry, relation_kinds, chunk->relation_base, from->relation_count);
+    OSM_COPY_ARRAY(chunk, geometry, relation_tag_counts, chunk->relation_base, from->relation_count);
+    for (size_t i = 0; i < from->relation_count; i++) {
+        geometry->relation_member_offsets[chunk->relation_base + i] = from->relation_member_offsets[i] + chunk->member_base;
+        geometry->relation_tag_offsets[chunk->relation_base + i] = from->relation_tag_offsets[i] + chunk->tag_base;
+    }
+
+    // Member ways already are indices in the whole geometry, resolved against the shared index
+    OSM_COPY_ARRAY(chunk, geometry, member_ways, chunk->member_base, from->member_count);
+    for (size_t i = 0; i < from->member_count; i++) {
+        geometry->member_roles[chunk->member_base + i] = from->member_roles[i] + chunk->string_base;
+    }
+    for (size_t i = 0; i < from->tag_count; i++) {
+        geometry->tag_keys[chunk->tag_base + i] = from->tag_keys[i] + chunk->string_base;
+        geometry->tag_values[chunk->tag_base + i] = from->tag_values[i] + chunk->string_base;
+    }
+    OSM_COPY_ARRAY(chunk, geometry, strings, chunk->string_base, from->strings_size);
+}
+
+// Reports the first chunk that failed, if any
+static bool OsmChunksParsed(const OsmChunks *chunks, const char *filename, Nob_String_View json) {
+    for (size_t i = 0; i < chunks->count; i++) {
+        const OsmChunk *chunk = &chunks->items[i];
+        if (chunk->ok) continue;
+        int context = (int)(json.data + json.count - chunk->error);
+        nob_log(NOB_ERROR, "Could not parse JSON file %s: %.*s", filename, context < 100 ? context : 100, chunk->error);
+        return false;
+    }
+    return true;
+}
+
+// Both passes run on every chunk in parallel. In between, the nodes and ways found by pass 1 are indexed
+// on one thread, in file order, so the ids resolve exactly as they would parsing the file in one go.
+static bool OsmLoadParallel(const char *filename, Nob_String_View json, size_t thread_count, OsmGeometry *geometry) {
+    bool result = false;
+    OsmChunks chunks = { .geometry = geometry };
+
+    if (!OsmSplitElements(filename, json.data, json.count, thread_count * OSM_CHUNKS_PER_THREAD, &chunks)) nob_return_defer(false);
+
+    ParallelFor(chunks.count, thread_count, OsmParseChunkPass1, &chunks);
+    if (!OsmChunksParsed(&chunks, filename, json)) nob_return_defer(false);
+
+    size_t node_count = 0;
+    size_t way_count = 0;
+    for (size_t i = 0; i < chunks.count; i++) {
+        node_count += chunks.items[i].loader.node_ids.count;
+        way_count += chunks.items[i].loader.way_ids.count;
+    }
+    IdMapReserve(&chunks.index.node_ids, node_count);
+    IdMapReserve(&chunks.index.way_ids, way_count);
+    way_count = 0;
+    for (size_t i = 0; i < chunks.count; i++) {
+        OsmIndexAdd(&chunks.index, &chunks.items[i].loader, way_count);
+        way_count += chunks.items[i].loader.way_ids.count;
+    }
+
+    ParallelFor(chunks.count, thread_count, OsmParseChunkPass2, &chunks);
+    if (!OsmChunksParsed(&chunks, filename, json)) nob_return_defer(false);
+
+    // Pass 1 only gave upper bounds, the merged arrays are sized from what pass 2 actually kept
+    OsmCounts counts = {0};
+    for (size_t i = 0; i < chunks.count; i++) {
+        OsmChunk *chunk = &chunks.items[i];
+        chunk->vertex_base = counts.vertices;
+        chunk->way_base = counts.ways;
+        chunk->relation_base = counts.relations;
+        chunk->member_base = counts.members;
+        chunk->tag_base = counts.tags;
+        chunk->string_base = counts.strings_size;
+        counts.vertices += chunk->geometry.vertex_count;
+        counts.ways += chunk->geometry.way_count;
+        counts.relations += chunk->geometry.relation_count;
+        counts.members += chunk->geometry.member_count;
+        counts.tags += chunk->geometry.tag_count;
+        counts.strings_size += chunk->geometry.strings_size;
+    }
+    OsmAllocate(geometry, &counts);
+    ParallelFor(chunks.count, thread_count, OsmMergeChunk, &chunks);
+    geometry->vertex_count = counts.vertices;
+    geometry->way_count = counts.ways;
+    geometry->relation_count = counts.relations;
+    geometry->member_count = counts.members;
+    geometry->tag_count = counts.tags;
+    geometry->strings_size = counts.strings_size;
+    result = true;
+
+defer:
+    for (size_t i = 0; i < chunks.count; i++) {
+        OsmLoaderFree(&chunks.items[i].loader);
+        UnloadOsmGeometry(&chunks.items[i].geometry);
+    }
+    nob_da_free(chunks);
+    OsmIndexFree(&chunks.index);
+    return result;
+}
+
+bool LoadOsmGeometryThreaded(const char *filename, OsmGeometry *geometry, size_t thread_count) {
+    bool result = false;
+    Nob_String_View json = {0};
+
+    *geometry = (OsmGeometry){0};
+
+    // Parsed in place from the page cache, the file is never copied
+    if (!nob_map_file(filename, &json)) nob_return_defer(false);
+
+    if (thread_count == 0) thread_count = (size_t)nob_nprocs();
+    if (thread_count > 1 && json.count >= OSM_PARALLEL_MIN_SIZE) {
+        result = OsmLoadParallel(filename, json, thread_count, geometry);
+    }
+    else {
+        result = OsmLoadSequential(filename, json, geometry);
+    }
+
+defer:
+    if (!result) UnloadOsmGeometry(geometry);
+    nob_unmap_file(json);
+    return result;
+}
+
+bool LoadOsmGeometry(const char *filename, OsmGeometry *geometry) {
+    return LoadOsmGeometryThreaded(filename, geometry, 0);
+}
+
+void UnloadOsmGeometry(OsmGeometry *geometry) {
+    if (geometry->mapping != NULL) {
+        UnmapOsmGeometryCache(geometry);
+        return;
+    }
+
+    NOB_FREE(geometry->vertices);
+    NOB_FREE(geometry->world_vertices);
+    NOB_FREE(geometry->vertex_importance);
+
+    NOB_FREE(geometry->way_ids);
+    NOB_FREE(geometry->way_offsets);
+    NOB_FREE(geometry->way_counts);
+    NOB_FREE(geometry->way_kinds);
+    NOB_FREE(geometry->way_tag_offsets);
+    NOB_FREE(geometry->way_tag_counts);
+
+    NOB_FREE(geometry->relation_ids);
+    NOB_FREE(geometry->relation_member_offsets);
+    NOB_FREE(geometry->relation_member_counts);
+    NOB_FREE(geometry->relation_kinds);
+    NOB_FREE(geometry->relation_tag_offsets);
+    NOB_FREE(geometry->relation_tag_counts);
+
+    NOB_FREE(geometry->member_ways);
+    NOB_FREE(geometry->member_roles);
+
+    NOB_FREE(geometry->tag_keys);
+    NOB_FREE(geometry->tag_values);
+
+    NOB_FREE(geometry->strings);
+    *geometry = (OsmGeometry){0};
+}
+
+const char *OsmWayTag(const OsmGeometry *geometry, size_t index, const char *key) {
+    return OsmFindTag(geometry, geometry->way_tag_offsets[index], geometry->way_tag_counts[index], key);
+}
+
+const char *OsmRelationTag(const OsmGeometry *geometry, size_t index, const char *key) {
+    return OsmFindTag(geometry, geometry->relation_tag_offsets[index], geometry->relation_tag_counts[index], key);
+}
@@ -0,0 +1,88 @@
+#ifndef OSM_H_
+#define OSM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "raylib.h"
+
+typedef enum {
+    OSM_KIND_OTHER = 0,
+    OSM_KIND_BUILDING, // building=*, building:part=*
+    OSM_KIND_PATH,     // highway=*
+    OSM_KIND_WATER,    // natural=water, water=*, waterway=*
+    OSM_KIND_RAIL,     // railway=*
+    OSM_KIND_COUNT,
+} OsmKind;
+
+// Every way and relation of an Overpass API JSON response, stored as a flat
+// struct-of-arrays: each array is allocated once with its final size.
+typedef struct {
+    // Shared vertex array, lat/lon in degrees. Way i owns
+    // vertices[way_offsets[i] .. way_offsets[i] + way_counts[i]).
+    Vector2 *vertices;
+    Vector3 *world_vertices;    // vertices on the ground in world space, see ProjectLatLonToWorld
+    // Largest Douglas-Peucker tolerance, in world units, at which a vertex survives the simplification of its way.
+    // The first and last vertex of every way are INFINITY.
+    float *vertex_importance;
+    size_t vertex_count;
+
+    int64_t *way_ids;
+    size_t *way_offsets;
+    size_t *way_counts;
+    uint8_t *way_kinds;         // OsmKind
+    size_t *way_tag_offsets;    // into tag_keys/tag_values
+    size_t *way_tag_counts;
+    size_t way_count;
+
+    // Relations reference their member ways by index. Members of other types are dropped.
+    int64_t *relation_ids;
+    size_t *relation_member_offsets; // into member_ways/member_roles
+    size_t *relation_member_counts;
+    uint8_t *relation_kinds;
+    size_t *relation_tag_offsets;
+    size_t *relation_tag_counts;
+    size_t relation_count;
+
+    size_t *member_ways;
+    size_t *member_roles;       // into strings
+    size_t member_count;
+
+    size_t *tag_keys;           // into strings
+    size_t *tag_values;         // into strings
+    size_t tag_count;
+
+    // NUL-terminated strings packed back to back
+    char *strings;
+    size_t strings_size;
+
+    // Set when the arrays point into a read-only mapped cache file instead of the heap
+    void *mapping;
+    size_t mapping_size;
+} OsmGeometry;
+
+// Loads all ways and relations of an Overpass API JSON response into `geometry`.
+bool LoadOsmGeometry(const char *filename, OsmGeometry *geometry);
+// Same, choosing the threads: files of OSM_PARALLEL_MIN_SIZE and more have their elements array
+// split into chunks parsed on `thread_count` threads (one per core if 0). 1 parses on the calling thread.
+#define OSM_PARALLEL_MIN_SIZE (4 * 1024 * 1024)
+bool LoadOsmGeometryThreaded(const char *filename, OsmGeometry *geometry, size_t thread_count);
+void UnloadOsmGeometry(OsmGeometry *geometry);
+
+// Baked binary cache of a loaded OsmGeometry (see osmcache.c). The cache records the size and
+// modification time of the JSON it was made from and is only used while they still match.
+#define OSM_CACHE_EXTENSION ".bin"
+bool SaveOsmGeometryCache(const OsmGeometry *geometry, const char *cache_path, const char *source_path);
+// Maps the cache read-only; the geometry arrays point straight into the file, nothing is parsed or copied.
+bool MapOsmGeometryCache(const char *cache_path, const char *source_path, OsmGeometry *geometry);
+// Called by UnloadOsmGeometry for mapped geometry
+void UnmapOsmGeometryCache(OsmGeometry *geometry);
+// Maps `filename` OSM_CACHE_EXTENSION if it is up to date, otherwise loads the JSON and writes the cache.
+bool LoadOsmGeometryCached(const char *filename, OsmGeometry *geometry);
+
+// Returns the value of tag `key` of way/relation `index`, or NULL if it has no such tag.
+const char *OsmWayTag(const OsmGeometry *geometry, size_t index, const char *key);
+const char *OsmRelationTag(const OsmGeometry *geometry, size_t index, const char *key);
+
+#endif // OSM_H_
@@ -0,0 +1,241 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "nob.h"
+#include "osm.h"
+#include "world.h"
+
+#define OSM_CACHE_MAGIC   0x4d534f44 // "DOSM" in little endian, reads differently on a big endian machine
+#define OSM_CACHE_VERSION 3
+#define OSM_CACHE_PROJECTION { MAP_LAT_MID, MAP_LON_MID, LAT_TO_METER, LON_TO_METER }
+#define OSM_CACHE_PATH_CAPACITY 4096
+#define OSM_CACHE_ALIGN(offset) (((offset) + 7) & ~(size_t)7)
+
+// The arrays, with the field holding their length, are stored in native layout, one after the other, each 8-byte aligned,
+// so a mapped file can be used in place.
+#define OSM_CACHE_ARRAYS(X)                            \
+    X(vertices,                vertex_count)           \
+    X(world_vertices,          vertex_count)           \
+    X(vertex_importance,       vertex_count)           \
+    X(way_ids,                 way_count)              \
+    X(way_offsets,             way_count)              \
+    X(way_counts,              way_count)              \
+    X(way_kinds,               way_count)              \
+    X(way_tag_offsets,         way_count)              \
+    X(way_tag_counts,          way_count)              \
+    X(relation_ids,            relation_count)         \
+    X(relation_member_offsets, relation_count)         \
+    X(relation_member_counts,  relation_count)         \
+    X(relation_kinds,          relation_count)         \
+    X(relation_tag_offsets,    relation_count)         \
+    X(relation_tag_counts,     relation_count)         \
+    X(member_ways,             member_count)           \
+    X(member_roles,            member_count)           \
+    X(tag_keys,                tag_count)              \
+    X(tag_values,              tag_count)              \
+    X(strings,                 strings_size)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size_t_size;
+    uint32_t vector2_size;
+    uint32_t vector3_size;
+    uint32_t padding;
+    double projection[4];       // world.h constants world_vertices were projected with
+    int64_t source_mtime;
+    uint64_t source_size;
+    uint64_t file_size;
+    uint64_t vertex_count;
+    uint64_t way_count;
+    uint64_t relation_count;
+    uint64_t member_count;
+    uint64_t tag_count;
+    uint64_t strings_size;
+} OsmCacheHeader;
+
+static bool OsmCacheStatSource(const char *source_path, int64_t *mtime, uint64_t *size) {
+    struct stat statbuf = {0};
+    if (stat(source_path, &statbuf) < 0) {
+        nob_log(NOB_ERROR, "could not stat %s: %s", source_path, strerror(errno));
+        return false;
+    }
+    *mtime = (int64_t)statbuf.st_mtime;
+    *size = (uint64_t)statbuf.st_size;
+    return true;
+}
+
+static size_t OsmCacheFileSize(const OsmGeometry *geometry) {
+    size_t offset = sizeof(OsmCacheHeader);
+#define X(array, length) offset = OSM_CACHE_ALIGN(offset) + geometry->length * sizeof(*geometry->array);
+    OSM_CACHE_ARRAYS(X)
+#undef X
+    return offset;
+}
+
+bool SaveOsmGeometryCache(const OsmGeometry *geometry, const char *cache_path, const char *source_path) {
+    bool result = false;
+    Nob_String_Builder sb = {0};
+    static const char padding[8] = {0};
+    // Not nob_temp_sprintf: caches are also written from loading jobs, and nob's temporary buffer is not thread-safe
+    char temp_path[OSM_CACHE_PATH_CAPACITY];
+    if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", cache_path) >= (int)sizeof(temp_path)) return false;
+
+    OsmCacheHeader header = {
+        .magic = OSM_CACHE_MAGIC,
+        .version = OSM_CACHE_VERSION,
+        .size_t_size = sizeof(size_t),
+        .vector2_size = sizeof(Vector2),
+        .vector3_size = sizeof(Vector3),
+        .projection = OSM_CACHE_PROJECTION,
+        .file_size = OsmCacheFileSize(geometry),
+        .vertex_count = geometry->vertex_count,
+        .way_count = geometry->way_count,
+        .relation_count = geometry->relation_count,
+        .member_count = geometry->member_count,
+        .tag_count = geometry->tag_count,
+        .strings_size = geometry->strings_size,
+    };
+    if (!OsmCacheStatSource(source_path, &header.source_mtime, &header.source_size)) nob_return_defer(false);
+
+    nob_sb_append_buf(&sb, (const char*)&header, sizeof(header));
+#define X(array, length)                                                                     \
+    nob_sb_append_buf(&sb, padding, OSM_CACHE_ALIGN(sb.count) - sb.count);                   \
+    nob_sb_append_buf(&sb, (const char*)geometry->array, geometry->length * sizeof(*geometry->array));
+    OSM_CACHE_ARRAYS(X)
+#undef X
+    NOB_ASSERT(sb.count == header.file_size);
+
+    // Write next to it and rename, so a reader never maps a half-written cache
+    if (!nob_write_entire_file(temp_path, sb.items, sb.count)) nob_return_defer(false);
+    if (!nob_rename(temp_path, cache_path)) nob_return_defer(false);
+    result = true;
+
+defer:
+    nob_sb_free(sb);
+    return result;
+}
+
+// Whether [offset, offset + count) lies in [0, size), without overflowing
+static bool OsmCacheRangeFits(size_t offset, size_t count, size_t size) {
+    return offset <= size && count <= size - offset;
+}
+
+// The sizes add up once the header matched, but the values inside the arrays are still whatever the file holds:
+// everything that indexes another array is checked once here so the rest of the app can trust it like a parsed geometry.
+static bool OsmCacheCheckArrays(const OsmGeometry *geometry) {
+    for (size_t i = 0; i < geometry->way_count; i++) {
+        if (!OsmCacheRangeFits(geometry->way_offsets[i], geometry->way_counts[i], geometry->vertex_count)) return false;
+        if (!OsmCacheRangeFits(geometry->way_tag_offsets[i], geometry->way_tag_counts[i], geometry->tag_count)) return false;
+        if (geometry->way_kinds[i] >= OSM_KIND_COUNT) return false;
+    }
+    for (size_t i = 0; i < geometry->relation_count; i++) {
+        if (!OsmCacheRangeFits(geometry->relation_member_offsets[i], geometry->relation_member_counts[i], geometry->member_count)) return false;
+        if (!OsmCacheRangeFits(geometry->relation_tag_offsets[i], geometry->relation_tag_counts[i], geometry->tag_count)) return false;
+        if (geometry->relation_kinds[i] >= OSM_KIND_COUNT) return false;
+    }
+    for (size_t i = 0; i < geometry->member_count; i++) {
+        if (geometry->member_ways[i] >= geometry->way_count) return false;
+        if (geometry->member_roles[i] >= geometry->strings_size) return false;
+    }
+    for (size_t i = 0; i < geometry->tag_count; i++) {
+        if (geometry->tag_keys[i] >= geometry->strings_size || geometry->tag_values[i] >= geometry->strings_size) return false;
+    }
+    // Every string offset then starts a string that ends inside the mapping
+    return geometry->strings_size == 0 || geometry->strings[geometry->strings_size - 1] == '\0';
+}
+
+bool MapOsmGeometryCache(const char *cache_path, const char *source_path, OsmGeometry *geometry) {
+    bool result = false;
+    Nob_String_View mapping = {0};
+    int64_t source_mtime = 0;
+    uint64_t source_size = 0;
+
+    *geometry = (OsmGeometry){0};
+
+    if (!OsmCacheStatSource(source_path, &source_mtime, &source_size)) nob_return_defer(false);
+
+    if (nob_file_exists(cache_path) != 1) nob_return_defer(false); // no cache yet
+    if (!nob_map_file(cache_path, &mapping)) nob_return_defer(false);
+    if (mapping.count < sizeof(OsmCacheHeader)) {
+        nob_log(NOB_WARNING, "ignoring truncated cache %s", cache_path);
+        nob_return_defer(false);
+    }
+
+    const OsmCacheHeader *header = (const OsmCacheHeader*)mapping.data;
+    if (header->magic != OSM_CACHE_MAGIC || header->version != OSM_CACHE_VERSION ||
+        header->size_t_size != sizeof(size_t) || header->vector2_size != sizeof(Vector2) ||
+        header->vector3_size != sizeof(Vector3) ||
+        header->file_size != (uint64_t)mapping.count) {
+        nob_log(NOB_WARNING, "ignoring incompatible cache %s", cache_path);
+        nob_return_defer(false);
+    }
+    const double projection[4] = OSM_CACHE_PROJECTION;
+    if (memcmp(header->projection, projection, sizeof(projection)) != 0) {
+        nob_log(NOB_INFO, "cache %s was projected for another map", cache_path);
+        nob_return_defer(false);
+    }
+    if (header->source_mtime != source_mtime || header->source_size != source_size) {
+        nob_log(NOB_INFO, "cache %s is out of date", cache_path);
+        nob_return_defer(false);
+    }
+
+    geometry->vertex_count = header->vertex_count;
+    geometry->way_count = header->way_count;
+    geometry->relation_count = header->relation_count;
+    geometry->member_count = header->member_count;
+    geometry->tag_count = header->tag_count;
+    geometry->strings_size = header->strings_size;
+    // Every array element takes at least a byte, so bounding the counts keeps OsmCacheFileSize from overflowing
+    if (header->vertex_count > header->file_size || header->way_count > header->file_size ||
+        header->relation_count > header->file_size || header->member_count > header->file_size ||
+        header->tag_count > header->file_size || header->strings_size > header->file_size ||
+        OsmCacheFileSize(geometry) != header->file_size) {
+        nob_log(NOB_WARNING, "ignoring inconsistent cache %s", cache_path);
+        nob_return_defer(false);
+    }
+
+    size_t offset = sizeof(OsmCacheHeader);
+#define X(array, length)                                                 \
+    offset = OSM_CACHE_ALIGN(offset);                                    \
+    geometry->array = (void*)(mapping.data + offset);                    \
+    offset += geometry->length * sizeof(*geometry->array);
+    OSM_CACHE_ARRAYS(X)
+#undef X
+    if (!OsmCacheCheckArrays(geometry)) {
+        nob_log(NOB_WARNING, "ignoring corrupt cache %s", cache_path);
+        nob_return_defer(false);
+    }
+
+    geometry->mapping = (void*)mapping.data;
+    geometry->mapping_size = mapping.count;
+    result = true;
+
+defer:
+    if (!result) {
+        nob_unmap_file(mapping);
+        *geometry = (OsmGeometry){0};
+    }
+    return result;
+}
+
+void UnmapOsmGeometryCache(OsmGeometry *geometry) {
+    nob_unmap_file(nob_sv_from_parts(geometry->mapping, geometry->mapping_size));
+    *geometry = (OsmGeometry){0};
+}
+
+bool LoadOsmGeometryCached(const char *filename, OsmGeometry *geometry) {
+    char cache_path[OSM_CACHE_PATH_CAPACITY];
+    if (snprintf(cache_path, sizeof(cache_path), "%s%s", filename, OSM_CACHE_EXTENSION) >= (int)sizeof(cache_path)) {
+        return LoadOsmGeometry(filename, geometry);
+    }
+
+    if (MapOsmGeometryCache(cache_path, filename, geometry)) return true;
+
+    if (!LoadOsmGeometry(filename, geometry)) return false;
+    if (!SaveOsmGeometryCache(geometry, cache_path, filename)) {
+        nob_log(NOB_WARNING, "could not write cache %s, it will be parsed again next time", cache_path);
+    }
+    return true;
+}
@@ -0,0 +1,175 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raymath.h"
+#include "polylines.h"
+#include "renderstats.h"
+#include "world.h"
+
+#define SEGMENT_VERTEX_COUNT 6
+// Slightly above the satellite map so the two do not z-fight
+#define POLYLINE_HEIGHT 0.1f
+
+static void WriteSegment(Vector3 a, Vector3 b, float half_width, Color color, float *vertices, unsigned char *colors) {
+    Vector3 direction = Vector3Normalize(Vector3Subtract(b, a));
+    // Perpendicular in the ground plane, on the side that makes the quad counter-clockwise seen from above
+    Vector3 side = { direction.z * half_width, 0.0f, -direction.x * half_width };
+    const Vector3 corners[SEGMENT_VERTEX_COUNT] = {
+        Vector3Subtract(a, side), Vector3Subtract(b, side), Vector3Add(b, side),
+        Vector3Subtract(a, side), Vector3Add(b, side),      Vector3Add(a, side),
+    };
+    for (size_t v = 0; v < SEGMENT_VERTEX_COUNT; v++) {
+        vertices[3*v + 0] = corners[v].x;
+        vertices[3*v + 1] = corners[v].y;
+        vertices[3*v + 2] = corners[v].z;
+        colors[4*v + 0] = color.r;
+        colors[4*v + 1] = color.g;
+        colors[4*v + 2] = color.b;
+        colors[4*v + 3] = color.a;
+    }
+}
+
+// Error allowed at a level of detail, in world units
+static float LodTolerance(size_t level) {
+    return POLYLINE_LOD_TOLERANCE * SCALE * (float)(1 << (2 * (level - 1)));
+}
+
+// Goes over the segments of every way at a level of detail, by the culling cell of their midpoint.
+// Only counts them into `cell_segments` when `layer` is NULL, otherwise writes them to the cells of `layer`.
+static void VisitSegments(const OsmGeometry *geometry, const Color kind_colors[OSM_KIND_COUNT], float half_width,
+                          size_t level, size_t cell_segments[CULL_GRID_CELLS], PolylineLayer *layer) {
+    const Vector3 lift = { 0.0f, POLYLINE_HEIGHT * SCALE, 0.0f };
+    const float tolerance = level == 0 ? 0.0f : LodTolerance(level);
+    for (size_t way = 0; way < geometry->way_count; way++) {
+        const Vector3 *vertices = &geometry->world_vertices[geometry->way_offsets[way]];
+        const float *way_importance = &geometry->vertex_importance[geometry->way_offsets[way]];
+        const Color color = kind_colors[geometry->way_kinds[way]];
+        if (geometry->way_counts[way] < 2) continue;
+
+        // `along` is how far the full-resolution way has come at vertex i, `a_along` at the start of the segment
+        Vector3 a = Vector3Add(vertices[0], lift);
+        float along = 0.0f, a_along = 0.0f;
+        for (size_t i = 1; i < geometry->way_counts[way]; i++) {
+            along += Vector3Distance(vertices[i - 1], vertices[i]);
+            if (level > 0 && way_importance[i] <= tolerance) continue;
+            Vector3 b = Vector3Add(vertices[i], lift);
+            // Repeated nodes have no direction to build a ribbon from
+            if (Vector3Equals(a, b)) continue;
+            size_t cell = CullGridCell(Vector3Lerp(a, b, 0.5f));
+            if (layer == NULL) {
+                cell_segments[cell]++;
+                a = b;
+                continue;
+            }
+
+            PolylineCell *polyline_cell = &layer->cells[cell];
+            size_t segment = polyline_cell->segment_counts[level];
+            float *segment_vertices = &polyline_cell->meshes[level].vertices[segment * SEGMENT_VERTEX_COUNT * 3];
+            WriteSegment(a, b, half_width, color, segment_vertices,
+                         &polyline_cell->meshes[level].colors[segment * SEGMENT_VERTEX_COUNT * 4]);
+            for (size_t v = 0; v < SEGMENT_VERTEX_COUNT; v++) {
+                Vector3 corner = { segment_vertices[3*v + 0], segment_vertices[3*v + 1], segment_vertices[3*v + 2] };
+                BoundingBox point = { corner, corner };
+                polyline_cell->bounds = polyline_cell->has_bounds ? BoundingBoxUnion(polyline_cell->bounds, point) : point;
+                polyline_cell->has_bounds = true;
+            }
+            polyline_cell->segment_counts[level]++;
+            layer->segment_counts[level]++;
+            layer->covered_lengths[level] += along - a_along;
+            a = b;
+            a_along = along;
+        }
+    }
+}
+
+PolylineLayer BuildPolylineLayer(const OsmGeometry *geometry, const Color kind_colors[OSM_KIND_COUNT], float width) {
+    PolylineLayer layer = { 0 };
+
+    // For every level, a first pass sizes every cell and a second one fills them
+    const float half_width = 0.5f * width * SCALE;
+    for (size_t level = 0; level < POLYLINE_LOD_COUNT; level++) {
+        size_t cell_segments[CULL_GRID_CELLS] = { 0 };
+        VisitSegments(geometry, kind_colors, half_width, level, cell_segments, NULL);
+        for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+            if (cell_segments[cell] == 0) continue;
+            Mesh *mesh = &layer.cells[cell].meshes[level];
+            mesh->vertices = MemAlloc(cell_segments[cell] * SEGMENT_VERTEX_COUNT * 3 * sizeof(float));
+            mesh->colors = MemAlloc(cell_segments[cell] * SEGMENT_VERTEX_COUNT * 4 * sizeof(unsigned char));
+        }
+        VisitSegments(geometry, kind_colors, half_width, level, cell_segments, &layer);
+
+        for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+            Mesh *mesh = &layer.cells[cell].meshes[level];
+            mesh->vertexCount = (int)(layer.cells[cell].segment_counts[level] * SEGMENT_VERTEX_COUNT);
+            mesh->triangleCount = mesh->vertexCount / 3;
+        }
+        // Every level covers each way from end to end exactly once, which drawing a single level for all the
+        // cells relies on: a stretch skipped or doubled here would be a gap or an overdraw on screen
+        float error = fabsf(layer.covered_lengths[level] - layer.covered_lengths[0]);
+        assert(error <= 1e-3f * fmaxf(layer.covered_lengths[0], 1.0f) && "Level of detail does not cover the ways");
+    }
+    return layer;
+}
+
+void UploadPolylineLayer(PolylineLayer *layer) {
+    layer->material = LoadMaterialDefault();
+    for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+        for (size_t level = 0; level < POLYLINE_LOD_COUNT; level++) {
+            if (layer->cells[cell].segment_counts[level] > 0) UploadMesh(&layer->cells[cell].meshes[level], false);
+        }
+    }
+}
+
+PolylineLayer LoadPolylineLayer(const OsmGeometry *geometry, const Color kind_colors[OSM_KIND_COUNT], float width) {
+    PolylineLayer layer = BuildPolylineLayer(geometry, kind_colors, width);
+    UploadPolylineLayer(&layer);
+    return layer;
+}
+
+void DrawPolylineLayer(const PolylineLayer *layer, const Frustum *frustum, Camera3D camera) {
+    // Each level assigns its segments to the cell of their own midpoint, so cells at different levels
+    // would draw the stretches near their border twice or not at all. The whole layer is drawn at the
+    // coarsest level whose error stays under a few pixels at the closest point of any cell in view.
+    const float screen_height = (float)GetScreenHeight();
+    bool visible[CULL_GRID_CELLS] = { 0 };
+    size_t level = POLYLINE_LOD_COUNT - 1;
+    for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+        const PolylineCell *polyline_cell = &layer->cells[cell];
+        if (!polyline_cell->has_bounds) continue;
+        if (!FrustumContainsBox(frustum, polyline_cell->bounds)) continue;
+        visible[cell] = true;
+
+        Vector3 closest = Vector3Clamp(camera.position, polyline_cell->bounds.min, polyline_cell->bounds.max);
+        float allowed = POLYLINE_LOD_PIXELS * CameraVisibleHeight(camera, closest) / screen_height;
+        size_t cell_level = 0;
+        while (cell_level + 1 < POLYLINE_LOD_COUNT && LodTolerance(cell_level + 1) <= allowed) cell_level++;
+        if (cell_level < level) level = cell_level;
+    }
+
+    for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+        const PolylineCell *polyline_cell = &layer->cells[cell];
+        if (!visible[cell] || polyline_cell->segment_counts[level] == 0) continue;
+        DrawMesh(polyline_cell->meshes[level], layer->material, MatrixIdentity());
+        CountDraw(1, (size_t)polyline_cell->meshes[level].vertexCount);
+    }
+}
+
+void UnloadPolylineLayer(PolylineLayer *layer) {
+    for (size_t cell = 0; cell < CULL_GRID_CELLS; cell++) {
+        for (size_t level = 0; level < POLYLINE_LOD_COUNT; level++) {
+            Mesh *mesh = &layer->cells[cell].meshes[level];
+            if (mesh->vaoId != 0) {
+                UnloadMesh(*mesh);
+            }
+            else {
+                RL_FREE(mesh->vertices);
+                RL_FREE(mesh->colors);
+            }
+        }
+    }
+    // The default material only references the default shader and texture, which it must not unload
+    RL_FREE(layer->material.maps);
+    *layer = (PolylineLayer){ 0 };
+}
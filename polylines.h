@@ -0,0 +1,42 @@
+#ifndef POLYLINES_H_
+#define POLYLINES_H_
+
+#include "raylib.h"
+#include "culling.h"
+#include "osm.h"
+
+// Levels of detail of a layer: level 0 has every vertex, level l > 0 keeps the vertices whose
+// Douglas-Peucker importance (see OsmGeometry) is above POLYLINE_LOD_TOLERANCE * 4^(l - 1) meters.
+#define POLYLINE_LOD_COUNT 4
+#define POLYLINE_LOD_TOLERANCE 1.0f
+// The coarsest level whose tolerance is under this many pixels at the closest cell in view is drawn
+#define POLYLINE_LOD_PIXELS 2.0f
+
+typedef struct {
+    Mesh meshes[POLYLINE_LOD_COUNT];
+    size_t segment_counts[POLYLINE_LOD_COUNT];
+    BoundingBox bounds;       // of the ribbons in the cell at every level, which may reach over its border
+    bool has_bounds;          // whether any level has a segment in the cell
+} PolylineCell;
+
+// Every way of an OsmGeometry projected to world space once and uploaded as static meshes.
+// rlgl can only draw vertex arrays as triangles, so each segment is a thin ribbon lying on the
+// ground, `width` meters wide. Segments are split by the culling grid cell of their midpoint,
+// one mesh per cell and level of detail; only the cells in view are drawn, all at the same level
+// since each level splits its segments by their own midpoints.
+typedef struct {
+    PolylineCell cells[CULL_GRID_CELLS];
+    Material material;
+    size_t segment_counts[POLYLINE_LOD_COUNT];
+    float covered_lengths[POLYLINE_LOD_COUNT]; // of the full-resolution ways spanned by the segments of each level
+} PolylineLayer;
+
+// Builds the meshes on the CPU, which may run on a job.
+PolylineLayer BuildPolylineLayer(const OsmGeometry *geometry, const Color kind_colors[OSM_KIND_COUNT], float width);
+// Uploads a built layer to the GPU.
+void UploadPolylineLayer(PolylineLayer *layer);
+PolylineLayer LoadPolylineLayer(const OsmGeometry *geometry, const Color kind_colors[OSM_KIND_COUNT], float width);
+void DrawPolylineLayer(const PolylineLayer *layer, const Frustum *frustum, Camera3D camera);
+void UnloadPolylineLayer(PolylineLayer *layer);
+
+#endif // POLYLINES_H_
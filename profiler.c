@@ -0,0 +1,125 @@
+#include <math.h>
+
+#include "raylib.h"
+#include "profiler.h"
+
+#define PROFILER_WIDTH 240
+#define PROFILER_GRAPH_HEIGHT 80
+#define PROFILER_GRAPH_SCALE (PROFILER_GRAPH_HEIGHT / (2.0 / 60.0))   // pixels per second, two 60 FPS frames fit
+#define PROFILER_GRAPH_PIXELS(seconds) ((int)fmin((seconds) * PROFILER_GRAPH_SCALE + 0.5, PROFILER_GRAPH_HEIGHT))
+#define PROFILER_FONT_SIZE 10
+
+Profiler profiler = { 0 };
+
+#if PROFILER
+static const char *phase_names[PROFILE_PHASE_COUNT] = {
+    [PROFILE_INPUT]     = "input",
+    [PROFILE_STREAMING] = "streaming",
+    [PROFILE_TIMELINE]  = "timeline",
+    [PROFILE_MAP]       = "map",
+    [PROFILE_CONTOUR]   = "contour",
+    [PROFILE_BUILDINGS] = "buildings",
+    [PROFILE_PRESENT]   = "EndDrawing",
+};
+#endif
+
+static const Color phase_colors[PROFILE_PHASE_COUNT] = {
+    [PROFILE_INPUT]     = GRAY,
+    [PROFILE_STREAMING] = PURPLE,
+    [PROFILE_TIMELINE]  = YELLOW,
+    [PROFILE_MAP]       = SKYBLUE,
+    [PROFILE_CONTOUR]   = ORANGE,
+    [PROFILE_BUILDINGS] = RED,
+    [PROFILE_PRESENT]   = DARKGREEN,
+};
+
+double ProfileNow(void) {
+    return GetTime();
+}
+
+void EndProfileFrame(void) {
+    double now = ProfileNow();
+    ProfileFrame *frame = &profiler.frames[profiler.next];
+    frame->total = profiler.frame_start > 0.0 ? now - profiler.frame_start : 0.0;
+    frame->stats = render_stats;
+    ResetRenderStats();
+    profiler.frame_start = now;
+
+    profiler.next = (profiler.next + 1) % PROFILER_HISTORY;
+    if (profiler.count < PROFILER_HISTORY) profiler.count++;
+    profiler.frames[profiler.next] = (ProfileFrame){ 0 };
+}
+
+// Frame `age` frames before the last complete one
+static const ProfileFrame *ProfileFrameAt(size_t age) {
+    return &profiler.frames[(profiler.next + PROFILER_HISTORY - 1 - age) % PROFILER_HISTORY];
+}
+
+void DrawProfiler(int x, int y) {
+    if (profiler.count == 0) return;
+    const int line = PROFILER_FONT_SIZE + 2;
+    const int height = (PROFILE_PHASE_COUNT + 5) * line + PROFILER_GRAPH_HEIGHT + 8;
+    DrawRectangle(x, y, PROFILER_WIDTH, height, Fade(BLACK, 0.75f));
+    x += 4;
+    y += 4;
+
+    double average_total = 0.0;
+    double worst_total = 0.0;
+    for (size_t age = 0; age < profiler.count; age++) {
+        const ProfileFrame *frame = ProfileFrameAt(age);
+        average_total += frame->total;
+        if (frame->total > worst_total) worst_total = frame->total;
+    }
+    average_total /= profiler.count;
+    DrawText(TextFormat("frame      %6.2f ms avg %6.2f max", average_total * 1e3, worst_total * 1e3),
+             x, y, PROFILER_FONT_SIZE, RAYWHITE);
+    y += line;
+
+#if PROFILER
+    for (size_t phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        double average = 0.0;
+        double worst = 0.0;
+        for (size_t age = 0; age < profiler.count; age++) {
+            double time = ProfileFrameAt(age)->phases[phase];
+            average += time;
+            if (time > worst) worst = time;
+        }
+        average /= profiler.count;
+        DrawText(TextFormat("%-10s %6.2f ms avg %6.2f max", phase_names[phase], average * 1e3, worst * 1e3),
+                 x, y, PROFILER_FONT_SIZE, phase_colors[phase]);
+        y += line;
+    }
+#else
+    DrawText("phase timers compiled out", x, y, PROFILER_FONT_SIZE, GRAY);
+    y += line * PROFILE_PHASE_COUNT;
+#endif
+
+    const RenderStats *stats = &ProfileFrameAt(0)->stats;
+    DrawText(TextFormat("draw calls %zu", stats->draw_calls), x, y, PROFILER_FONT_SIZE, RAYWHITE);
+    y += line;
+    DrawText(TextFormat("vertices %zu", stats->vertices), x, y, PROFILER_FONT_SIZE, RAYWHITE);
+    y += line;
+    DrawText(TextFormat("texture binds %zu", stats->texture_binds), x, y, PROFILER_FONT_SIZE, RAYWHITE);
+    y += line + 4;
+
+    // One column per frame, the newest on the right, stacking the phases from the bottom
+    const int bottom = y + PROFILER_GRAPH_HEIGHT;
+    const int columns = PROFILER_WIDTH - 8;
+    for (int column = 0; column < columns && (size_t)column < profiler.count; column++) {
+        const ProfileFrame *frame = ProfileFrameAt((size_t)column);
+        int column_x = x + columns - 1 - column;
+        int top = bottom;
+        for (size_t phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            int pixels = PROFILER_GRAPH_PIXELS(frame->phases[phase]);
+            if (top - pixels < y) pixels = top - y;
+            DrawRectangle(column_x, top - pixels, 1, pixels, phase_colors[phase]);
+            top -= pixels;
+        }
+        // What the phases do not cover
+        int total = PROFILER_GRAPH_PIXELS(frame->total);
+        if (bottom - total < top) DrawRectangle(column_x, bottom - total, 1, top - (bottom - total), DARKGRAY);
+    }
+    // 60 FPS budget
+    int budget = bottom - (int)(PROFILER_GRAPH_SCALE / 60.0);
+    DrawLine(x, budget, x + columns, budget, Fade(RAYWHITE, 0.5f));
+}
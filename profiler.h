@@ -0,0 +1,60 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "renderstats.h"
+
+// Build with -DPROFILER=0 to compile the timers out
+#ifndef PROFILER
+#define PROFILER 1
+#endif
+
+#define PROFILER_HISTORY 240    // frames kept for the graph
+
+typedef enum {
+    PROFILE_INPUT,
+    PROFILE_STREAMING,      // job completions and tile requests
+    PROFILE_TIMELINE,       // rebuilding the buildings mesh for the year
+    PROFILE_MAP,
+    PROFILE_CONTOUR,
+    PROFILE_BUILDINGS,
+    PROFILE_PRESENT,        // EndDrawing, which waits for the GPU and swaps
+    PROFILE_PHASE_COUNT,
+} ProfilePhase;
+
+typedef struct {
+    double phases[PROFILE_PHASE_COUNT];    // in seconds
+    double total;
+    RenderStats stats;
+} ProfileFrame;
+
+// Timings of the last PROFILER_HISTORY frames, in a ring buffer
+typedef struct {
+    ProfileFrame frames[PROFILER_HISTORY];
+    size_t next;            // where the frame being measured goes
+    size_t count;
+    double frame_start;
+    bool visible;
+} Profiler;
+
+extern Profiler profiler;
+
+#if PROFILER
+// Times the statement or block that follows into `phase`, which must not be left with break or return:
+//   PROFILE(PROFILE_MAP) DrawTileMap(map);
+#define PROFILE(phase)                                                                         \
+    for (double profile_start_ = ProfileNow(), profile_once_ = 1; profile_once_;               \
+         profile_once_ = 0, profiler.frames[profiler.next].phases[(phase)] += ProfileNow() - profile_start_)
+#else
+#define PROFILE(phase)
+#endif
+
+double ProfileNow(void);
+// Closes the frame being measured with the render stats counted during it, and starts the next one.
+void EndProfileFrame(void);
+// Overlay with the average and worst time of every phase, the stats of the last frame and a graph of the frame times.
+void DrawProfiler(int x, int y);
+
+#endif // PROFILER_H_
@@ -0,0 +1,3 @@
+#include "renderstats.h"
+
+RenderStats render_stats = { 0 };
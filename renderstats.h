@@ -0,0 +1,29 @@
+#ifndef RENDERSTATS_H_
+#define RENDERSTATS_H_
+
+#include <stddef.h>
+
+// What the layers submitted to the GPU since the last ResetRenderStats. rlgl does not count
+// anything itself, so every draw function adds what it submits.
+typedef struct {
+    size_t draw_calls;    // meshes and textured quads, each its own draw; shapes batched by rlgl are not counted
+    size_t vertices;
+    size_t texture_binds;
+} RenderStats;
+
+extern RenderStats render_stats;
+
+static inline void CountDraw(size_t draw_calls, size_t vertices) {
+    render_stats.draw_calls += draw_calls;
+    render_stats.vertices += vertices;
+}
+
+static inline void CountTextureBind(void) {
+    render_stats.texture_binds++;
+}
+
+static inline void ResetRenderStats(void) {
+    render_stats = (RenderStats){ 0 };
+}
+
+#endif // RENDERSTATS_H_
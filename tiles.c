@@ -0,0 +1,231 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nob.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "culling.h"
+#include "renderstats.h"
+#include "tiles.h"
+#include "world.h"
+
+#define TILE_PATH_CAPACITY 1024
+
+// World extent of the map quad: lat grows along +x, lon along +z, and the image's top row is north
+#define TILE_WORLD_HEIGHT ((float)(MAP_LAT_HEIGHT * LAT_TO_METER))
+#define TILE_WORLD_WIDTH  ((float)(MAP_LON_WIDTH * LON_TO_METER))
+
+typedef struct {
+    TileMap *map;
+    TileKey key;
+    char path[TILE_PATH_CAPACITY];
+    Image image;
+} TileJob;
+
+static bool TileKeyEquals(TileKey a, TileKey b) {
+    return a.level == b.level && a.x == b.x && a.y == b.y;
+}
+
+static TileCacheEntry *FindTile(TileMap *map, TileKey key) {
+    for (size_t i = 0; i < map->cache_count; i++) {
+        if (TileKeyEquals(map->cache[i].key, key)) return &map->cache[i];
+    }
+    return NULL;
+}
+
+// A tile that failed to load is cached too, without a texture, so it is not requested again
+static void CacheTile(TileMap *map, TileKey key, Image image) {
+    if (FindTile(map, key) != NULL) {
+        UnloadImage(image);
+        return;
+    }
+
+    TileCacheEntry *entry = NULL;
+    if (map->cache_count < TILE_CACHE_CAPACITY) {
+        entry = &map->cache[map->cache_count++];
+    }
+    else {
+        entry = &map->cache[0];
+        for (size_t i = 1; i < map->cache_count; i++) {
+            if (map->cache[i].last_used < entry->last_used) entry = &map->cache[i];
+        }
+        if (entry->texture.id != 0) UnloadTexture(entry->texture);
+    }
+
+    entry->key = key;
+    entry->texture = (Texture2D){ 0 };
+    entry->last_used = map->frame;
+    if (!IsImageValid(image)) return;
+
+    entry->texture = LoadTextureFromImage(image);
+    // The pyramid levels are mipmaps of each other, per tile mipmaps only smooth the zoom in between
+    GenTextureMipmaps(&entry->texture);
+    SetTextureFilter(entry->texture, TEXTURE_FILTER_TRILINEAR);
+    SetTextureWrap(entry->texture, TEXTURE_WRAP_CLAMP);
+    UnloadImage(image);
+}
+
+TileMap *LoadTileMap(const char *directory, JobSystem *jobs) {
+    TileMap *map = NOB_REALLOC(NULL, sizeof(*map));
+    NOB_ASSERT(map != NULL && "Buy more RAM lol");
+    *map = (TileMap){ .directory = directory, .jobs = jobs };
+
+    Nob_String_Builder sb = {0};
+    const char *index_path = nob_temp_sprintf("%s/%s", directory, TILE_INDEX_NAME);
+    if (!nob_file_exists(index_path) || !nob_read_entire_file(index_path, &sb)) {
+        nob_log(NOB_WARNING, "no tile pyramid in %s, run ./nob bake", directory);
+        return map;
+    }
+    nob_sb_append_null(&sb);
+    map->levels = atoi(sb.items);
+    nob_sb_free(sb);
+    if (map->levels <= 0 || map->levels > TILE_MAX_LEVELS) {
+        nob_log(NOB_ERROR, "%s: invalid level count", index_path);
+        map->levels = 0;
+        return map;
+    }
+
+    return map;
+}
+
+// Decoding and file reading, on a worker
+static void LoadTileJob(void *data) {
+    TileJob *job = data;
+    job->image = LoadImage(job->path);
+}
+
+// GPU upload, on the main thread
+static void TileJobCompleted(void *data) {
+    TileJob *job = data;
+    TileMap *map = job->map;
+    for (size_t i = 0; i < map->pending_count; i++) {
+        if (TileKeyEquals(map->pending[i], job->key)) {
+            map->pending[i] = map->pending[--map->pending_count];
+            break;
+        }
+    }
+    CacheTile(map, job->key, job->image);
+    NOB_FREE(job);
+}
+
+static void RequestTile(TileMap *map, TileKey key) {
+    if (map->pending_count == TILE_MAX_PENDING || FindTile(map, key) != NULL) return;
+    for (size_t i = 0; i < map->pending_count; i++) {
+        if (TileKeyEquals(map->pending[i], key)) return;
+    }
+
+    TileJob *job = NOB_REALLOC(NULL, sizeof(*job));
+    NOB_ASSERT(job != NULL && "Buy more RAM lol");
+    *job = (TileJob){ .map = map, .key = key };
+    snprintf(job->path, sizeof(job->path), TILE_PATH_FORMAT, map->directory, key.level, key.x, key.y);
+    map->pending[map->pending_count++] = key;
+    SubmitJob(map->jobs, LoadTileJob, TileJobCompleted, job);
+}
+
+// Tiles of `level` overlapping the square of half size `half` around `center`; false if there are none
+static bool TileRange(int level, Vector3 center, float half, int *x_min, int *x_max, int *y_min, int *y_max) {
+    int tiles = 1 << level;
+    float tile_width = TILE_WORLD_WIDTH / tiles;
+    float tile_height = TILE_WORLD_HEIGHT / tiles;
+    float u_min = floorf((center.z - half + 0.5f * TILE_WORLD_WIDTH) / tile_width);
+    float u_max = floorf((center.z + half + 0.5f * TILE_WORLD_WIDTH) / tile_width);
+    float v_min = floorf((0.5f * TILE_WORLD_HEIGHT - (center.x + half)) / tile_height);
+    float v_max = floorf((0.5f * TILE_WORLD_HEIGHT - (center.x - half)) / tile_height);
+    if (u_max < 0.0f || v_max < 0.0f || u_min >= tiles || v_min >= tiles) return false;
+    *x_min = (int)fmaxf(u_min, 0.0f);
+    *x_max = (int)fminf(u_max, tiles - 1);
+    *y_min = (int)fmaxf(v_min, 0.0f);
+    *y_max = (int)fminf(v_max, tiles - 1);
+    return true;
+}
+
+void UpdateTileMap(TileMap *map, Camera3D camera) {
+    map->frame++;
+    map->level = -1;
+    if (map->levels == 0) return;
+
+    // Finest level whose texels are at least as dense as the screen's pixels
+    float visible = CameraVisibleHeight(camera, camera.target);
+    float needed = (float)GetScreenHeight() / visible * fmaxf(TILE_WORLD_WIDTH, TILE_WORLD_HEIGHT) / TILE_SIZE;
+    int level = needed <= 1.0f ? 0 : (int)ceilf(log2f(needed));
+    if (level > map->levels - 1) level = map->levels - 1;
+
+    float aspect = (float)GetScreenWidth() / (float)GetScreenHeight();
+    float half = 0.5f * visible * fmaxf(aspect, 1.0f);
+    if (camera.projection != CAMERA_ORTHOGRAPHIC) half *= 2.0f; // a tilted view sees farther than its target
+    for (; level >= 0; level--) {
+        if (!TileRange(level, camera.target, half, &map->x_min, &map->x_max, &map->y_min, &map->y_max)) break;
+        if ((map->x_max - map->x_min + 1) * (map->y_max - map->y_min + 1) <= TILE_MAX_VISIBLE) {
+            map->level = level;
+            break;
+        }
+    }
+
+    // The root first so there is always something to fall back to, then the view
+    RequestTile(map, (TileKey){ 0, 0, 0 });
+    for (int y = map->y_min; map->level > 0 && y <= map->y_max; y++) {
+        for (int x = map->x_min; x <= map->x_max; x++) RequestTile(map, (TileKey){ map->level, x, y });
+    }
+}
+
+// Draws the map area of tile `key` with the `source` part (in texture coordinates) of `texture`
+// Adapted from https://www.raylib.com/examples/models/loader.html?name=models_draw_cube_texture
+static void DrawTileQuad(Texture2D texture, TileKey key, Rectangle source) {
+    int tiles = 1 << key.level;
+    float width = TILE_WORLD_WIDTH / tiles;
+    float height = TILE_WORLD_HEIGHT / tiles;
+    float z0 = -0.5f * TILE_WORLD_WIDTH + key.x * width;
+    float z1 = z0 + width;
+    float x0 = 0.5f * TILE_WORLD_HEIGHT - key.y * height;
+    float x1 = x0 - height;
+    float u0 = source.x, u1 = source.x + source.width;
+    float v0 = source.y, v1 = source.y + source.height;
+
+    // Every texture change flushes rlgl's batch, so each tile is a draw of its own
+    CountDraw(1, 4);
+    CountTextureBind();
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+        rlColor4ub(0xff, 0xff, 0xff, 0xff);
+        rlNormal3f(0.0f, 1.0f, 0.0f);
+        rlTexCoord2f(u0, v1); rlVertex3f(x1, 0.0f, z0);
+        rlTexCoord2f(u1, v1); rlVertex3f(x1, 0.0f, z1);
+        rlTexCoord2f(u1, v0); rlVertex3f(x0, 0.0f, z1);
+        rlTexCoord2f(u0, v0); rlVertex3f(x0, 0.0f, z0);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+void DrawTileMap(TileMap *map) {
+    if (map->level < 0) return;
+    for (int y = map->y_min; y <= map->y_max; y++) {
+        for (int x = map->x_min; x <= map->x_max; x++) {
+            TileKey key = { map->level, x, y };
+            // The tile itself, else the part of its closest loaded ancestor that covers it
+            for (int up = 0; up <= key.level; up++) {
+                TileKey ancestor = { key.level - up, x >> up, y >> up };
+                TileCacheEntry *entry = FindTile(map, ancestor);
+                if (entry == NULL || entry->texture.id == 0) continue;
+
+                float size = 1.0f / (float)(1 << up);
+                Rectangle source = {
+                    (x - (ancestor.x << up)) * size,
+                    (y - (ancestor.y << up)) * size,
+                    size, size,
+                };
+                DrawTileQuad(entry->texture, key, source);
+                entry->last_used = map->frame;
+                break;
+            }
+        }
+    }
+}
+
+void UnloadTileMap(TileMap *map) {
+    for (size_t i = 0; i < map->cache_count; i++) {
+        if (map->cache[i].texture.id != 0) UnloadTexture(map->cache[i].texture);
+    }
+    NOB_FREE(map);
+}
@@ -0,0 +1,61 @@
+#ifndef TILES_H_
+#define TILES_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+#include "jobs.h"
+
+// Layout of a baked tile pyramid (see baketiles.c)
+#define TILE_SIZE 256
+#define TILE_MAX_LEVELS 12
+#define TILE_INDEX_NAME "levels.txt"          // number of levels, written once the pyramid is complete
+#define TILE_PATH_FORMAT "%s/%d/%d_%d.png"    // directory, level, x, y
+#define TILE_DIRECTORY_EXTENSION ".tiles"     // assets/maps/foo.png is baked to assets/maps/foo.tiles/
+
+#define TILE_CACHE_CAPACITY 96   // GPU tiles kept around, ~24MB of RGBA at TILE_SIZE
+#define TILE_MAX_VISIBLE 48      // coarser levels are used when the view would need more tiles
+#define TILE_MAX_PENDING 4       // tile jobs in flight, few so that tiles going out of view are not loaded
+
+typedef struct {
+    int level;
+    int x;
+    int y;
+} TileKey;
+
+typedef struct {
+    TileKey key;
+    Texture2D texture;
+    unsigned last_used;      // frame the tile was last drawn in
+} TileCacheEntry;
+
+// Satellite basemap streamed from a baked tile pyramid. Tiles for the current view are decoded
+// by jobs and uploaded when their completion runs, and at most TILE_CACHE_CAPACITY of
+// them live on the GPU, the least recently drawn being evicted first. Tiles that are not loaded
+// yet are drawn from the closest loaded ancestor.
+typedef struct {
+    const char *directory;
+    int levels;              // 0 when no pyramid was baked, nothing is drawn then
+
+    TileCacheEntry cache[TILE_CACHE_CAPACITY];
+    size_t cache_count;
+    unsigned frame;
+
+    // Chosen by UpdateTileMap for DrawTileMap
+    int level;
+    int x_min, x_max, y_min, y_max;
+
+    JobSystem *jobs;
+    TileKey pending[TILE_MAX_PENDING];
+    size_t pending_count;
+} TileMap;
+
+TileMap *LoadTileMap(const char *directory, JobSystem *jobs);
+// Chooses the tiles the camera needs and submits jobs for the missing ones.
+void UpdateTileMap(TileMap *map, Camera3D camera);
+void DrawTileMap(TileMap *map);
+// After StopJobs, as the completions of tile jobs still in flight reference the map.
+void UnloadTileMap(TileMap *map);
+
+#endif // TILES_H_
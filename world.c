@@ -0,0 +1,90 @@
+#include "world.h"
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
+// The map center split into a float and the float remainder: lat - hi is exact for every
+// lat on the map, so subtracting lo afterwards keeps the double precision of MAP_*_MID
+#define LAT_MID_HI ((float)MAP_LAT_MID)
+#define LAT_MID_LO ((float)(MAP_LAT_MID - (double)LAT_MID_HI))
+#define LON_MID_HI ((float)MAP_LON_MID)
+#define LON_MID_LO ((float)(MAP_LON_MID - (double)LON_MID_HI))
+
+static void ProjectLatLonToWorldScalar(const Vector2 *latlon, size_t count, float height, Vector3 *world) {
+    for (size_t i = 0; i < count; i++) {
+        world[i].x = ((latlon[i].x - LAT_MID_HI) - LAT_MID_LO) * (float)LAT_TO_METER;
+        world[i].y = height * SCALE;
+        world[i].z = ((latlon[i].y - LON_MID_HI) - LON_MID_LO) * (float)LON_TO_METER;
+    }
+}
+
+#if defined(__SSE2__)
+
+// 4 vertices per iteration: two loads of (lat, lon, lat, lon), projected in place,
+// then shuffled with the height into three stores of (x, y, z, x) (y, z, x, y) (z, x, y, z)
+static size_t ProjectLatLonToWorldSimd(const Vector2 *latlon, size_t count, float height, Vector3 *world) {
+    const __m128 mid_hi = _mm_setr_ps(LAT_MID_HI, LON_MID_HI, LAT_MID_HI, LON_MID_HI);
+    const __m128 mid_lo = _mm_setr_ps(LAT_MID_LO, LON_MID_LO, LAT_MID_LO, LON_MID_LO);
+    const __m128 scale = _mm_setr_ps((float)LAT_TO_METER, (float)LON_TO_METER, (float)LAT_TO_METER, (float)LON_TO_METER);
+    const __m128 y = _mm_set1_ps(height * SCALE);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float *in = (const float*)&latlon[i];
+        float *out = (float*)&world[i];
+        __m128 a = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(in + 0), mid_hi), mid_lo), scale); // x0 z0 x1 z1
+        __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(in + 4), mid_hi), mid_lo), scale); // x2 z2 x3 z3
+
+        __m128 x0y = _mm_unpacklo_ps(a, y);                                                 // x0 y  z0 y
+        __m128 z1x2 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 3, 3));                        // z1 z1 x2 x2
+        __m128 yz1 = _mm_unpacklo_ps(y, z1x2);                                              // y  z1 y  z1
+        __m128 x2y = _mm_unpackhi_ps(z1x2, y);                                              // x2 y  x2 y
+        __m128 yx3 = _mm_unpackhi_ps(y, b);                                                 // y  x3 y  z3
+
+        _mm_storeu_ps(out + 0, _mm_shuffle_ps(x0y, a, _MM_SHUFFLE(2, 1, 1, 0)));            // x0 y  z0 x1
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(yz1, x2y, _MM_SHUFFLE(1, 0, 1, 0)));          // y  z1 x2 y
+        _mm_storeu_ps(out + 8, _mm_shuffle_ps(b, yx3, _MM_SHUFFLE(3, 2, 2, 1)));            // z2 x3 y  z3
+    }
+    return i;
+}
+
+#elif defined(__ARM_NEON)
+
+// 4 vertices per iteration, deinterleaved into lat/lon lanes by vld2q and interleaved back by vst3q
+static size_t ProjectLatLonToWorldSimd(const Vector2 *latlon, size_t count, float height, Vector3 *world) {
+    const float32x4_t lat_hi = vdupq_n_f32(LAT_MID_HI);
+    const float32x4_t lat_lo = vdupq_n_f32(LAT_MID_LO);
+    const float32x4_t lon_hi = vdupq_n_f32(LON_MID_HI);
+    const float32x4_t lon_lo = vdupq_n_f32(LON_MID_LO);
+    const float32x4_t lat_scale = vdupq_n_f32((float)LAT_TO_METER);
+    const float32x4_t lon_scale = vdupq_n_f32((float)LON_TO_METER);
+
+    float32x4x3_t out;
+    out.val[1] = vdupq_n_f32(height * SCALE);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t in = vld2q_f32((const float*)&latlon[i]);
+        out.val[0] = vmulq_f32(vsubq_f32(vsubq_f32(in.val[0], lat_hi), lat_lo), lat_scale);
+        out.val[2] = vmulq_f32(vsubq_f32(vsubq_f32(in.val[1], lon_hi), lon_lo), lon_scale);
+        vst3q_f32((float*)&world[i], out);
+    }
+    return i;
+}
+
+#else
+
+static size_t ProjectLatLonToWorldSimd(const Vector2 *latlon, size_t count, float height, Vector3 *world) {
+    (void)latlon; (void)count; (void)height; (void)world;
+    return 0;
+}
+
+#endif
+
+void ProjectLatLonToWorld(const Vector2 *latlon, size_t count, float height, Vector3 *world) {
+    size_t done = ProjectLatLonToWorldSimd(latlon, count, height, world);
+    ProjectLatLonToWorldScalar(latlon + done, count - done, height, world + done);
+}
@@ -0,0 +1,36 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include <stddef.h>
+
+#include "raylib.h"
+
+// Extent of the map and the mapping from lat/lon to world space
+
+#define MAP_LAT_MIN 48.868276
+#define MAP_LAT_MAX 48.876301
+#define MAP_LAT_MID ((MAP_LAT_MIN + MAP_LAT_MAX) * 0.5)
+#define MAP_LAT_HEIGHT (MAP_LAT_MAX - MAP_LAT_MIN)
+
+#define MAP_LON_MIN 2.768697
+#define MAP_LON_MAX 2.784665
+#define MAP_LON_MID ((MAP_LON_MIN + MAP_LON_MAX) * 0.5)
+#define MAP_LON_WIDTH (MAP_LON_MAX - MAP_LON_MIN)
+
+#define SCALE 0.01f // factor 1/100 to circumvent fixed frustrum limitation
+#define LAT_TO_METER (111319.9 * SCALE)
+#define LON_TO_METER (73324.94 * SCALE)
+
+static inline Vector3 latlon_to_world(const Vector2 latlon, const float height) {
+    return (Vector3){
+        (latlon.x - MAP_LAT_MID) * LAT_TO_METER,
+        height * SCALE,
+        (latlon.y - MAP_LON_MID) * LON_TO_METER
+    };
+}
+
+// Batch version of latlon_to_world for loading, SIMD where available (see world.c).
+// Works in float only and agrees with latlon_to_world to within a float rounding.
+void ProjectLatLonToWorld(const Vector2 *latlon, size_t count, float height, Vector3 *world);
+
+#endif // WORLD_H_